@@ -0,0 +1,216 @@
+#include "Si7021.h"
+#include "Si7021Continuous.h"
+#include "Si7021Scheduler.h"
+#include "Si7021Sim.h"
+
+//no sensor needed: the driver talks to a model of the Si7021 with a virtual clock
+Si7021Sim sim;
+Si7021 si7021(sim);
+
+#define READINGS 100
+
+//virtual time the main loop spends on its own work between two poll() calls, in microseconds
+#define LOOP_TIME 100
+
+//length of the runs of the non-blocking paths, in microseconds of virtual time
+#define RUN_TIME 10000000UL
+
+//one blocking measure() per reading, in the given ready mode
+void benchmark(const char* name, Si7021::ReadyMode mode, uint8_t resolution){
+
+  if(!si7021.setReadyMode(mode)){
+    Serial.print(name);
+    Serial.println(": not supported on this platform");
+    return;
+  }
+  si7021.setSensorResolution(resolution);
+
+  sim.resetCounters();
+  uint32_t start = sim.micros();
+  uint32_t cpuStart = micros();
+  uint8_t errors = 0;
+  for(int i = 0; i < READINGS; i++){
+    Si7021::Reading reading;
+    if(si7021.measure(reading) != Si7021::STATUS_OK){
+      errors++;
+    }
+  }
+  //virtual time: conversions and bus transfers. CPU time: the driver's own work, waits cost nothing
+  uint32_t cpu = micros() - cpuStart;
+  uint32_t latency = (sim.micros() - start) / READINGS;
+
+  Serial.print(name);
+  Serial.print(" res ");
+  Serial.print(resolution);
+  Serial.print(": ");
+  Serial.print(latency);
+  Serial.print("us/reading, ");
+  Serial.print((float)sim.getTransactions() / READINGS);
+  Serial.print(" transactions/reading (");
+  Serial.print((float)sim.getNacks() / READINGS);
+  Serial.print(" NACKed), ");
+  Serial.print(1000000.0f / latency);
+  Serial.print(" samples/s, ");
+  Serial.print(cpu / READINGS);
+  Serial.print("us CPU/reading, ");
+  Serial.print(errors);
+  Serial.println(" errors");
+}
+
+//one non-blocking humidity measurement per reading, polled from a main loop
+void benchmarkNonBlocking(const char* name, Si7021::ReadyMode mode){
+
+  si7021.setReadyMode(mode);
+  si7021.setSensorResolution(0);
+
+  sim.resetCounters();
+  uint32_t start = sim.micros();
+  uint32_t polls = 0;
+  uint32_t longest = 0;
+  uint8_t errors = 0;
+  for(int i = 0; i < READINGS; i++){
+    if(!si7021.startHumidityMeasurement(true)){
+      errors++;
+      continue;
+    }
+    Si7021::State state;
+    do{
+      sim.wait(LOOP_TIME);
+      //time the main loop is held up by one call
+      uint32_t before = sim.micros();
+      state = si7021.poll();
+      uint32_t held = sim.micros() - before;
+      if(held > longest){
+        longest = held;
+      }
+      polls++;
+    } while(state == Si7021::STATE_CONVERTING);
+    if(isnan(si7021.getResult())){
+      errors++;
+    }
+  }
+  uint32_t latency = (sim.micros() - start) / READINGS;
+
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(latency);
+  Serial.print("us/reading, ");
+  Serial.print((float)sim.getTransactions() / READINGS);
+  Serial.print(" transactions/reading, ");
+  Serial.print((float)polls / READINGS);
+  Serial.print(" poll() calls/reading, longest ");
+  Serial.print(longest);
+  Serial.print("us, ");
+  Serial.print(errors);
+  Serial.println(" errors");
+}
+
+//continuous sampling at 10Hz, drained as it goes
+void benchmarkContinuous(){
+
+  si7021.setReadyMode(Si7021::READY_NACK_POLLING);
+  Si7021::Reading samples[16];
+  Si7021Continuous sampling(si7021);
+  sampling.start(samples, 16, 100);
+
+  sim.resetCounters();
+  uint32_t start = sim.micros();
+  uint32_t readings = 0;
+  uint32_t longest = 0;
+  while(sim.micros() - start < RUN_TIME){
+    sim.wait(LOOP_TIME);
+    uint32_t before = sim.micros();
+    sampling.poll();
+    uint32_t held = sim.micros() - before;
+    if(held > longest){
+      longest = held;
+    }
+    Si7021::Reading reading;
+    while(sampling.drain(&reading, 1)){
+      readings++;
+    }
+  }
+  sampling.stop();
+
+  Serial.print("continuous 10Hz: ");
+  Serial.print(readings * 1000000.0f / RUN_TIME);
+  Serial.print(" samples/s, ");
+  Serial.print(readings ? (float)sim.getTransactions() / readings : 0.0f);
+  Serial.print(" transactions/sample, longest poll() ");
+  Serial.print(longest);
+  Serial.print("us, ");
+  Serial.print(sampling.getDroppedCount());
+  Serial.println(" dropped");
+}
+
+//temperature at 10Hz and humidity every 2s through the scheduler, which merges the two when it can
+void benchmarkScheduler(){
+
+  Si7021Scheduler scheduler(si7021);
+  scheduler.setTemperaturePlan(100);
+  scheduler.setHumidityPlan(2000, 100);
+
+  sim.resetCounters();
+  uint32_t start = sim.micros();
+  uint32_t temperatures = 0;
+  uint32_t humidities = 0;
+  uint32_t longest = 0;
+  while(sim.micros() - start < RUN_TIME){
+    sim.wait(LOOP_TIME);
+    uint32_t before = sim.micros();
+    uint8_t updated = scheduler.poll();
+    uint32_t held = sim.micros() - before;
+    if(held > longest){
+      longest = held;
+    }
+    if(updated & SI7021_SCHEDULER_TEMPERATURE){
+      temperatures++;
+    }
+    if(updated & SI7021_SCHEDULER_HUMIDITY){
+      humidities++;
+    }
+  }
+  //the last conversion may still be running: let it end before the next run
+  si7021.cancelMeasurement();
+  while(si7021.poll() == Si7021::STATE_CONVERTING){
+  }
+
+  Serial.print("scheduler 10Hz/0.5Hz: ");
+  Serial.print(temperatures * 1000000.0f / RUN_TIME);
+  Serial.print(" temperatures/s, ");
+  Serial.print(humidities * 1000000.0f / RUN_TIME);
+  Serial.print(" humidities/s, ");
+  Serial.print((float)sim.getTransactions() * 1000000.0f / RUN_TIME);
+  Serial.print(" transactions/s, longest poll() ");
+  Serial.print(longest);
+  Serial.println("us");
+}
+
+
+void setup() {
+
+  Serial.begin(115200);
+
+  sim.setEnvironment(5500, 2150);
+  si7021.begin();
+
+  for(uint8_t resolution = 0; resolution < 4; resolution++){
+    benchmark("timed", Si7021::READY_TIMED, resolution);
+    benchmark("polling", Si7021::READY_NACK_POLLING, resolution);
+    benchmark("hold", Si7021::READY_HOLD_MASTER, resolution);
+  }
+
+  //the same measurement without blocking: the main loop keeps running during the conversion
+  benchmarkNonBlocking("non-blocking timed", Si7021::READY_TIMED);
+  benchmarkNonBlocking("non-blocking polling", Si7021::READY_NACK_POLLING);
+  benchmarkContinuous();
+  benchmarkScheduler();
+
+  //one frame in ten corrupted at 400Khz: the checksum catches them
+  sim.setBusClock(400000);
+  sim.setCrcErrorInterval(10);
+  benchmark("polling 400Khz, CRC errors", Si7021::READY_NACK_POLLING, 0);
+}
+
+void loop() {
+}
@@ -0,0 +1,38 @@
+#include "Si7021.h"
+#include "Si7021Codec.h"
+#include "Si7021Continuous.h"
+
+Si7021 si7021;
+Si7021Continuous sampling(si7021);
+
+static Si7021::Reading samples[64];
+
+//a full batch of 32 readings is 201 bytes, against ~30 bytes of text per reading
+static uint8_t batch[SI7021_CODEC_SIZE(32)];
+
+unsigned long lastReport = 0;
+
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+  sampling.start(samples, 64, 1000);
+}
+
+void loop() {
+
+  sampling.poll();
+
+  //every 30 seconds, straight from the sampling buffer to the link: no floats, no text
+  if(millis() - lastReport > 30000){
+    lastReport = millis();
+
+    size_t length;
+    while((length = Si7021Codec::encode(batch, sizeof(batch), sampling)) > 0){
+      Serial.write(batch, length);
+    }
+  }
+
+}
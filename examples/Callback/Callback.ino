@@ -0,0 +1,42 @@
+#include "Si7021.h"
+
+Si7021 si7021;
+
+void onHumidity(Si7021& sensor, void* context);
+
+void onTemperature(Si7021& sensor, void* context) {
+  if(sensor.getStatus() == Si7021::STATUS_OK){
+    Serial.print("Temperature: ");
+    Serial.print(sensor.getResult());
+    Serial.println("C");
+  }
+  //alternate between humidity and temperature
+  sensor.requestHumidity(onHumidity);
+}
+
+void onHumidity(Si7021& sensor, void* context) {
+  if(sensor.getStatus() == Si7021::STATUS_OK){
+    Serial.print("Humidity: ");
+    Serial.print(sensor.getResult());
+    Serial.println("%");
+  }
+  sensor.requestTemperature(onTemperature);
+}
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+  //with an RTOS, protect the bus shared with other tasks:
+  //si7021.setBusLock(takeMutex, giveMutex, &wireMutex);
+
+  si7021.requestHumidity(onHumidity);
+}
+
+void loop() {
+
+  //the callbacks are called from here once a conversion is done
+  si7021.poll();
+
+}
@@ -0,0 +1,31 @@
+#include "Si7021T.h"
+
+//8 bit RH / 12 bit temperature, checksum verified, integer hundredths: no float code is compiled in.
+//Wait times are constants: a humidity measurement blocks for Sensor::HUMIDITY_CONVERSION_TIME (6.9ms) only
+typedef Si7021T<1, true, SI7021_UNIT_CENTI> Sensor;
+
+Sensor si7021(Wire);
+
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+}
+
+void loop() {
+
+  Sensor::Humidity humidity;
+  Sensor::Temperature temperature;
+
+  if(si7021.measureHumidity(humidity) && si7021.getTemperatureFromPreviousHumidityMeasurement(temperature)){
+    Serial.print("Humidity (x100): ");
+    Serial.print(humidity);
+    Serial.print("% - Temperature (x100): ");
+    Serial.print(temperature);
+    Serial.println("C");
+  }
+  delay(500);
+
+}
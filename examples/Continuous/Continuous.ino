@@ -0,0 +1,45 @@
+#include "Si7021.h"
+#include "Si7021Continuous.h"
+
+Si7021 si7021;
+Si7021Continuous sampling(si7021);
+
+//raw readings are 8 bytes each: 64 samples fit in 512 bytes of RAM
+static Si7021::Reading samples[64];
+
+unsigned long lastReport = 0;
+
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+  //one sample every second, in the background
+  sampling.start(samples, 64, 1000);
+}
+
+void loop() {
+
+  //starts the conversions and stores the results: never blocks
+  sampling.poll();
+
+  //ship a batch every 30 seconds. Conversion to engineering units is only done here
+  if(millis() - lastReport > 30000){
+    lastReport = millis();
+
+    Si7021::Reading batch[8];
+    size_t n;
+    while((n = sampling.drain(batch, 8)) > 0){
+      for(size_t i = 0; i < n; i++){
+        Serial.print(batch[i].timestamp);
+        Serial.print(": ");
+        Serial.print(batch[i].getHumidity());
+        Serial.print("% - ");
+        Serial.print(batch[i].getTemperature());
+        Serial.println("C");
+      }
+    }
+  }
+
+}
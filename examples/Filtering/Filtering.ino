@@ -0,0 +1,38 @@
+#include "Si7021.h"
+#include "Si7021Filter.h"
+
+Si7021 si7021;
+
+//spikes out first, then smoothing of the humidity. The temperature is oversampled: 16 conversions per output
+Si7021Median<5> humidityMedian;
+Si7021Ema humidityEma(3);
+Si7021Decimator temperatureDecimator(4);
+
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+  //faster conversions, the decimator makes up for the lost resolution
+  si7021.setSensorResolution(3);
+}
+
+void loop() {
+
+  //filters work on the raw codes: no floating point math until a value is printed
+  if(humidityMedian.add(si7021.measureHumidityRaw())){
+    humidityEma.add(humidityMedian.get());
+  }
+
+  if(temperatureDecimator.add(si7021.getTemperatureFromPreviousHumidityMeasurementRaw())){
+    Serial.print("Humidity: ");
+    Serial.print(Si7021::convertHumidity(humidityEma.getFullCode()));
+    Serial.print("% - Temperature: ");
+    //the full code keeps the resolution gained below the 11 bits of the sensor: up to 2 bits for 16 conversions
+    Serial.print(Si7021::convertTemperature(temperatureDecimator.getFullCode()), 3);
+    Serial.println("C");
+  }
+
+  delay(100);
+}
@@ -0,0 +1,48 @@
+#include "Si7021.h"
+#include "Si7021Continuous.h"
+#include "Si7021HeaterControl.h"
+
+Si7021 si7021;
+Si7021Continuous sampling(si7021);
+Si7021HeaterControl heater(si7021);
+
+static Si7021::Reading samples[16];
+
+bool wasHeating = false;
+
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+  //one sample every 5 seconds, in the background
+  sampling.start(samples, 16, 5000);
+
+  //above 90% RH run the heater at 0x04 (28mA at 3.3V) for 30s to dry the sensor,
+  //then throw away the next 3 readings while it cools down
+  heater.start(9000, 0x04, 30, 3);
+  sampling.setHeaterControl(&heater);
+}
+
+void loop() {
+
+  //samples, switches the heater on and off: never blocks
+  sampling.poll();
+
+  if(heater.isHeating() != wasHeating){
+    wasHeating = heater.isHeating();
+    Serial.println(wasHeating ? "Heater ON" : "Heater OFF");
+  }
+
+  //readings taken while heating never make it to the buffer
+  Si7021::Reading reading;
+  while(sampling.drain(&reading, 1) > 0){
+    Serial.print("Humidity: ");
+    Serial.print(reading.getHumidity());
+    Serial.print("% - Temperature: ");
+    Serial.print(reading.getTemperature());
+    Serial.println("C");
+  }
+
+}
@@ -0,0 +1,74 @@
+#include "Si7021.h"
+#include "Si7021LowPower.h"
+
+#if defined(ARDUINO_ARCH_AVR)
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <avr/interrupt.h>
+
+//the watchdog only wakes the MCU up
+ISR(WDT_vect){
+  wdt_disable();
+}
+
+//power down in 16ms watchdog steps. Timer0 is stopped meanwhile so millis() and micros() don't see that time:
+//Si7021LowPower makes up for it from the value returned
+uint32_t sleepHook(uint32_t duration, void* context){
+  uint32_t slept = 0;
+  while(slept < duration){
+    cli();
+    MCUSR &= ~(1 << WDRF);
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = (1 << WDIE); //interrupt only, ~16ms
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    slept += 16000;
+  }
+  return slept;
+}
+#else
+//no portable sleep: stand-in for the platform's light sleep
+uint32_t sleepHook(uint32_t duration, void* context){
+  delay(duration / 1000 + 1);
+  return duration;
+}
+#endif
+
+Si7021 si7021;
+
+//sleep through the conversions instead of busy waiting
+Si7021LowPower lowPower(si7021, sleepHook);
+
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+  //3.3V, ~5mA awake and ~5uA asleep for an ATmega328P at 8Mhz
+  lowPower.setPowerProfile(3300, 5000, 5);
+}
+
+void loop() {
+
+  Si7021::Reading reading;
+  if(lowPower.measure(reading) == Si7021::STATUS_OK){
+    Serial.print("Humidity: ");
+    Serial.print(reading.getHumidity());
+    Serial.print("% - Temperature: ");
+    Serial.print(reading.getTemperature());
+    Serial.print("C - awake ");
+    Serial.print(lowPower.getLastAwakeTime());
+    Serial.print("us, asleep ");
+    Serial.print(lowPower.getLastSleepTime());
+    Serial.print("us, ");
+    Serial.print(lowPower.getLastEnergy());
+    Serial.println("uJ");
+    Serial.flush();
+  }
+
+  delay(5000);
+}
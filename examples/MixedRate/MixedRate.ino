@@ -0,0 +1,41 @@
+#include "Si7021.h"
+#include "Si7021Scheduler.h"
+
+Si7021 sensor;
+Si7021Scheduler scheduler(sensor);
+
+
+void setup() {
+
+  Serial.begin(115200);
+  sensor.begin();
+
+  //temperature at 10 Hz, 12 bit: 3.8ms conversions
+  scheduler.setTemperaturePlan(100);
+  //humidity every 2 seconds, at most 100ms late so it lands on a temperature sample: one conversion gives both
+  scheduler.setHumidityPlan(2000, 100);
+}
+
+void loop() {
+
+  uint8_t updated = scheduler.poll();
+
+  if(updated & SI7021_SCHEDULER_TEMPERATURE){
+    Serial.print("Temperature: ");
+    Serial.print(Si7021::convertTemperature(scheduler.getTemperatureCode()));
+    Serial.println("C");
+  }
+
+  if(updated & SI7021_SCHEDULER_HUMIDITY){
+    Serial.print("Humidity: ");
+    Serial.print(Si7021::convertHumidity(scheduler.getHumidityCode()));
+    Serial.println("%");
+  }
+
+  if(scheduler.isStale(SI7021_SCHEDULER_TEMPERATURE | SI7021_SCHEDULER_HUMIDITY)){
+    Serial.println("Sensor is not answering");
+    delay(1000);
+  }
+
+  //the rest of the control loop goes here, poll() never blocks
+}
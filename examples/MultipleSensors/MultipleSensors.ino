@@ -0,0 +1,43 @@
+#include "Si7021.h"
+#include "Si7021Array.h"
+
+//one sensor per I2C bus. Wire1 is available on ESP32, SAMD and most ARM boards
+Si7021 sensor0(Wire);
+Si7021 sensor1(Wire1);
+
+Si7021* sensors[] = { &sensor0, &sensor1 };
+Si7021Array array(sensors, 2);
+
+
+void setup() {
+
+  Serial.begin(115200);
+  sensor0.begin();
+  sensor1.begin();
+
+  array.startHumidityMeasurement();
+}
+
+void loop() {
+
+  //both sensors convert at the same time: results come in the order they complete
+  int8_t i = array.poll();
+  if(i >= 0){
+    Serial.print("Sensor ");
+    Serial.print(i);
+    if(array.getState(i) == Si7021::STATE_READY){
+      Serial.print(" humidity: ");
+      Serial.print(array.getSensor(i)->getResult());
+      Serial.println("%");
+    }
+    else{
+      Serial.println(" did not answer");
+    }
+  }
+
+  if(array.isDone()){
+    delay(1000);
+    array.startHumidityMeasurement();
+  }
+
+}
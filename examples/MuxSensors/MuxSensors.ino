@@ -0,0 +1,50 @@
+#include "Si7021.h"
+#include "Si7021Array.h"
+#include "Si7021Mux.h"
+
+//eight sensors at address 0x40, one per channel of a TCA9548A at 0x70
+Si7021Mux mux(Wire);
+Si7021 sensors[8];
+Si7021* pointers[] = { &sensors[0], &sensors[1], &sensors[2], &sensors[3], &sensors[4], &sensors[5], &sensors[6], &sensors[7] };
+Si7021Array array(pointers, 8);
+
+
+void setup() {
+
+  Serial.begin(115200);
+
+  for(uint8_t i = 0; i < 8; i++){
+    sensors[i].setMuxChannel(Si7021Mux::selectChannel, i, &mux);
+    sensors[i].begin();
+  }
+
+  //one instruction on all channels at once starts the eight conversions together
+  array.setMux(&mux);
+  array.startHumidityMeasurement();
+}
+
+void loop() {
+
+  //results are collected one channel at a time, the multiplexer is only written when the channel changes
+  int8_t i = array.poll();
+  if(i >= 0){
+    Serial.print("Channel ");
+    Serial.print(i);
+    if(array.getState(i) == Si7021::STATE_READY){
+      Serial.print(" humidity: ");
+      Serial.print(array.getSensor(i)->getResult());
+      Serial.println("%");
+    }
+    else{
+      Serial.println(" did not answer");
+    }
+  }
+
+  if(array.isDone()){
+    Serial.print("Multiplexer writes so far: ");
+    Serial.println(mux.getSwitchCount());
+    delay(1000);
+    array.startHumidityMeasurement();
+  }
+
+}
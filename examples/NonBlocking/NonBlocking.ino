@@ -0,0 +1,45 @@
+#include "Si7021.h"
+
+Si7021 si7021;
+
+unsigned long lastBlink = 0;
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  si7021.startHumidityMeasurement();
+}
+
+void loop() {
+
+  //poll() never blocks: the rest of the loop keeps running while the sensor converts
+  Si7021::State state = si7021.poll();
+
+  if(state == Si7021::STATE_READY){
+    Serial.print("Humidity: ");
+    Serial.print(si7021.getResult());
+    Serial.print("% - Temperature: ");
+    Serial.print(si7021.getTemperatureFromPreviousHumidityMeasurement());
+    Serial.println("C");
+
+    si7021.startHumidityMeasurement();
+  }
+  else if(state != Si7021::STATE_CONVERTING){
+    //timeout, corrupted data or sensor missing: getStatus() tells which
+    Serial.print("Si7021 error ");
+    Serial.println(si7021.getStatus());
+    delay(1000);
+    si7021.startHumidityMeasurement();
+  }
+
+  //something else that must not be delayed by the sensor
+  if(millis() - lastBlink > 250){
+    lastBlink = millis();
+    digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+  }
+
+}
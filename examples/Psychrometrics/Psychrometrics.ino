@@ -0,0 +1,32 @@
+#include "Si7021.h"
+#include "Si7021Psychrometrics.h"
+
+Si7021 si7021;
+
+
+void setup() {
+
+  Serial.begin(115200);
+  si7021.begin();
+}
+
+void loop() {
+
+  //a single conversion gives both the humidity and the temperature
+  Si7021::Reading reading;
+  if(si7021.measure(reading) == Si7021::STATUS_OK){
+
+    //fixed point: a table lookup instead of logf/expf
+    Si7021Psychrometrics climate(reading);
+
+    Serial.print("Dew point: ");
+    Serial.print(climate.dewPoint / 100.0);
+    Serial.print("C - Absolute humidity: ");
+    Serial.print(climate.absoluteHumidity / 100.0);
+    Serial.print("g/m3 - Vapour pressure: ");
+    Serial.print(climate.vapourPressure);
+    Serial.println("Pa");
+  }
+
+  delay(2000);
+}
@@ -0,0 +1,195 @@
+/*
+  Arduino.cpp
+  Host side of Arduino.h and Wire.h, and the main() that runs a sketch:
+  setup() once, then loop() as many times as the first argument says
+  (none by default).
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdio.h>
+#include <time.h>
+#include <Arduino.h>
+#include <Wire.h>
+
+HardwareSerial Serial;
+TwoWire Wire;
+TwoWire Wire1;
+
+/// <returns>Host monotonic clock, in microseconds. Wraps at 2^32 like on a board</returns>
+static uint64_t now(){
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000ULL + time.tv_nsec / 1000;
+}
+
+static const uint64_t start = now();
+
+uint32_t micros(){
+	return (uint32_t)(now() - start);
+}
+
+uint32_t millis(){
+	return (uint32_t)((now() - start) / 1000);
+}
+
+void delay(uint32_t ms){
+	delayMicroseconds(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us){
+	struct timespec time = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+	nanosleep(&time, NULL);
+}
+
+void pinMode(uint8_t pin, uint8_t mode){
+	(void)pin;
+	(void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value){
+	(void)pin;
+	(void)value;
+}
+
+int digitalRead(uint8_t pin){
+	(void)pin;
+	return LOW;
+}
+
+void HardwareSerial::begin(uint32_t baud){
+	(void)baud;
+}
+
+void HardwareSerial::flush(){
+	fflush(stdout);
+}
+
+HardwareSerial::operator bool(){
+	return true;
+}
+
+size_t HardwareSerial::write(uint8_t value){
+	return fwrite(&value, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size){
+	return fwrite(buffer, 1, size, stdout);
+}
+
+size_t HardwareSerial::print(const char* text){
+	return printf("%s", text);
+}
+
+size_t HardwareSerial::print(char value){
+	return printf("%c", value);
+}
+
+size_t HardwareSerial::print(long value, int base){
+	return base == HEX ? printf("%lX", (unsigned long)value) : printf("%ld", value);
+}
+
+size_t HardwareSerial::print(unsigned long value, int base){
+	return base == HEX ? printf("%lX", value) : printf("%lu", value);
+}
+
+size_t HardwareSerial::print(int value, int base){
+	return this->print((long)value, base);
+}
+
+size_t HardwareSerial::print(unsigned int value, int base){
+	return this->print((unsigned long)value, base);
+}
+
+size_t HardwareSerial::print(double value, int digits){
+	return printf("%.*f", digits, value);
+}
+
+size_t HardwareSerial::println(){
+	return printf("\n");
+}
+
+size_t HardwareSerial::println(const char* text){
+	return this->print(text) + this->println();
+}
+
+size_t HardwareSerial::println(char value){
+	return this->print(value) + this->println();
+}
+
+size_t HardwareSerial::println(long value, int base){
+	return this->print(value, base) + this->println();
+}
+
+size_t HardwareSerial::println(unsigned long value, int base){
+	return this->print(value, base) + this->println();
+}
+
+size_t HardwareSerial::println(int value, int base){
+	return this->print(value, base) + this->println();
+}
+
+size_t HardwareSerial::println(unsigned int value, int base){
+	return this->print(value, base) + this->println();
+}
+
+size_t HardwareSerial::println(double value, int digits){
+	return this->print(value, digits) + this->println();
+}
+
+void TwoWire::begin(){
+}
+
+void TwoWire::setClock(uint32_t hz){
+	(void)hz;
+}
+
+void TwoWire::beginTransmission(uint8_t address){
+	(void)address;
+}
+
+size_t TwoWire::write(uint8_t value){
+	(void)value;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t* bytes, size_t length){
+	(void)bytes;
+	return length;
+}
+
+//2: NACK on address, there is no device
+uint8_t TwoWire::endTransmission(bool stop){
+	(void)stop;
+	return 2;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool stop){
+	(void)address;
+	(void)quantity;
+	(void)stop;
+	return 0;
+}
+
+int TwoWire::available(){
+	return 0;
+}
+
+int TwoWire::read(){
+	return -1;
+}
+
+void setup();
+void loop();
+
+int main(int argc, char** argv){
+	long loops = argc > 1 ? atol(argv[1]) : 0;
+	setup();
+	for(long i = 0; i < loops; i++){
+		loop();
+	}
+	fflush(stdout);
+	return 0;
+}
@@ -0,0 +1,73 @@
+/*
+  Arduino.h
+  Just enough of the Arduino core to build the library and its examples on a
+  computer, see Makefile. The clock is the host's, the serial port is the
+  standard output.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_HOST_ARDUINO_H
+#define SI7021_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define LED_BUILTIN 13
+
+#define DEC 10
+#define HEX 16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+class HardwareSerial
+{
+	public:
+		void begin(uint32_t baud);
+		void flush();
+		operator bool();
+		size_t write(uint8_t value);
+		size_t write(const uint8_t* buffer, size_t size);
+		size_t print(const char* text);
+		size_t print(char value);
+		size_t print(long value, int base = DEC);
+		size_t print(unsigned long value, int base = DEC);
+		size_t print(int value, int base = DEC);
+		size_t print(unsigned int value, int base = DEC);
+		size_t print(double value, int digits = 2);
+		size_t println();
+		size_t println(const char* text);
+		size_t println(char value);
+		size_t println(long value, int base = DEC);
+		size_t println(unsigned long value, int base = DEC);
+		size_t println(int value, int base = DEC);
+		size_t println(unsigned int value, int base = DEC);
+		size_t println(double value, int digits = 2);
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,33 @@
+/*
+  Wire.h
+  I2C bus of the host build, with nothing on it: every address is NACKed.
+  Run the examples against Si7021Sim to have a sensor.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_HOST_WIRE_H
+#define SI7021_HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire
+{
+	public:
+		void begin();
+		void setClock(uint32_t hz);
+		void beginTransmission(uint8_t address);
+		size_t write(uint8_t value);
+		size_t write(const uint8_t* bytes, size_t length);
+		uint8_t endTransmission(bool stop = true);
+		uint8_t requestFrom(uint8_t address, uint8_t quantity, bool stop = true);
+		int available();
+		int read();
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
@@ -0,0 +1,10 @@
+/*
+  arduino.h
+  Same as Arduino.h, for file systems where the case matters.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include "Arduino.h"
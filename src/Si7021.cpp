@@ -16,96 +16,1022 @@
 #include <Wire.h>
 #include "Si7021.h"
 
-Si7021::Si7021(){};
+//maximum conversion times, in microseconds, indexed by timing family then RES[1:0]
+//on the Si70xx a humidity measurement also converts the temperature so both times are added up
+//RES :	RH		Temp
+// 00	:	12 bit	14 bit
+// 01	:	8 bit	12 bit
+// 10	:	10 bit	13 bit
+// 11	:	11 bit	11 bit
+#define SI7021_TIMING_SI70XX 0
+#define SI7021_TIMING_SHT2X 1
+static const uint32_t SI7021_HUMIDITY_CONVERSION_TIME[2][4] PROGMEM = {
+	{
+		SI7021_HUMIDITY_CONVERSION_TIME_12BIT + SI7021_TEMPERATURE_CONVERSION_TIME_14BIT,
+		SI7021_HUMIDITY_CONVERSION_TIME_8BIT + SI7021_TEMPERATURE_CONVERSION_TIME_12BIT,
+		SI7021_HUMIDITY_CONVERSION_TIME_10BIT + SI7021_TEMPERATURE_CONVERSION_TIME_13BIT,
+		SI7021_HUMIDITY_CONVERSION_TIME_11BIT + SI7021_TEMPERATURE_CONVERSION_TIME_11BIT
+	},
+	//SHT21 datasheet, which covers the slower HTU21D as well
+	{ 29000, 4000, 9000, 15000 }
+};
+static const uint32_t SI7021_TEMPERATURE_CONVERSION_TIME[2][4] PROGMEM = {
+	{
+		SI7021_TEMPERATURE_CONVERSION_TIME_14BIT,
+		SI7021_TEMPERATURE_CONVERSION_TIME_12BIT,
+		SI7021_TEMPERATURE_CONVERSION_TIME_13BIT,
+		SI7021_TEMPERATURE_CONVERSION_TIME_11BIT
+	},
+	{ 85000, 22000, 43000, 11000 }
+};
 
-void Si7021::begin(){
-  //init Arduino I2C lib
-  Wire.begin();
+//what a variant supports on top of the measurements, the registers and the electronic ID
+#define SI7021_CAPABILITY_PREVIOUS_TEMPERATURE 0x01	//0xE0: temperature converted along with the last RH measurement
+#define SI7021_CAPABILITY_FIRMWARE_REVISION 0x02	//0x84 0xB8
+#define SI7021_CAPABILITY_HEATER_LEVEL 0x04			//heater control register
+
+//capabilities and timing family, indexed by Si7021::Variant
+static const uint8_t SI7021_VARIANTS[][2] PROGMEM = {
+	{ 0x07, SI7021_TIMING_SI70XX },	//VARIANT_UNKNOWN
+	{ 0x07, SI7021_TIMING_SI70XX },	//VARIANT_SI7013
+	{ 0x07, SI7021_TIMING_SI70XX },	//VARIANT_SI7020
+	{ 0x07, SI7021_TIMING_SI70XX },	//VARIANT_SI7021
+	{ 0x07, SI7021_TIMING_SI70XX },	//VARIANT_SI70XX
+	{ 0x00, SI7021_TIMING_SHT2X }	//VARIANT_SHT2X
+};
+
+//counting code of the stats, compiled out when disabled
+#if SI7021_STATS
+#define SI7021_COUNT(statement) statement
+#else
+#define SI7021_COUNT(statement)
+#endif
+
+#if SI7021_CRC_MODE == SI7021_CRC_TABLE
+//CRC-8 of every byte value, polynomial 0x31
+static const uint8_t SI7021_CRC_TABLE_DATA[256] PROGMEM = {
+	0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+	0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4, 0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+	0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11, 0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+	0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+	0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA, 0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+	0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9, 0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+	0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C, 0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+	0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F, 0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+	0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED, 0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+	0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE, 0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+	0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B, 0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+	0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+	0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0, 0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+	0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93, 0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+	0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+	0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15, 0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC
+};
+#endif
+
+Si7021::Si7021(TwoWire& wire, uint8_t address) :
+	_wireBus(wire), _bus(NULL), _address(address), _select(NULL), _selectContext(NULL), _channel(0),
+	_lock(NULL), _unlock(NULL), _lockContext(NULL),
+	_completion(NULL), _completionContext(NULL),
+	_state(STATE_IDLE), _status(STATUS_OK), _present(true), _command(0x00), _returnSize(0),
+	_startTime(0), _nextAttempt(0), _readyMode(READY_TIMED), _pollInterval(SI7021_POLL_INTERVAL), _result(0),
+	_readBack(false), _discard(false), _readBackTemperature(0), _conversionTime(0),
+	_userRegister(SI7021_USER_REGISTER_DEFAULT), _heaterRegister(SI7021_HEATER_CONTROL_REGISTER_DEFAULT),
+	_serialA(0), _serialB(0), _firmwareVersion(0x00), _identityRead(false), _variant(VARIANT_UNKNOWN) {
+	SI7021_COUNT(this->resetStats());
+};
+
+/// <summary>Driver going through any bus and time source, eg: a Si7021Sim to run without a sensor</summary>
+/// <param name="bus">Bus the sensor is on. Must outlive this object</param>
+/// <param name="address">7 bit address of the sensor</param>
+Si7021::Si7021(Si7021Bus& bus, uint8_t address) : Si7021(Wire, address) {
+	//our own Wire adapter is left unused
+	_bus = &bus;
+};
+
+/// <summary>
+///		Initialize the bus and check that the sensor answers.
+/// </summary>
+/// <returns>TRUE if the sensor was found</returns>
+bool Si7021::begin(){
+  return this->connect(true);
+}
+
+/// <summary>
+///		Initialize the bus and bring the sensor to a configuration. The sensor keeps its configuration while powered, so
+///		on a warm boot (eg: wake up from deep sleep) the registers already match: nothing is reset nor written and the
+///		first sample can be taken right away. Otherwise the sensor is reset and configured.
+///		The identity is read on first access instead, see getVariant().
+/// </summary>
+/// <param name="config">Resolution and heater settings</param>
+/// <returns>TRUE if the sensor was found and configured</returns>
+bool Si7021::begin(const Config& config){
+
+	//reads both registers once
+	if(!this->connect(false)){
+		return false;
+	}
+
+	//RES1, HTRE and RES0. The other bits are reserved or read only
+	const uint8_t mask = 0x85;
+	uint8_t wanted = ((config.resolution & 0x02) << 6) | (config.heater ? 0x04 : 0x00) | (config.resolution & 0x01);
+	bool match = (_userRegister & mask) == wanted;
+	if(match && config.heater && (this->getCapabilities() & SI7021_CAPABILITY_HEATER_LEVEL)){
+		match = (_heaterRegister & 0x0F) == (config.heaterPower & 0x0F);
+	}
+	if(match){
+		return true;
+	}
+
+	this->reset();
+	if(!_present){
+		return false;
+	}
+
+	//registers are back to their defaults: only the settings that differ are written
+	return this->setSensorResolution(config.resolution) && this->setHeater(config.heater, config.heaterPower);
+}
+
+/// <summary>Initialize the bus, check that the sensor answers and take a copy of its registers, see begin()</summary>
+/// <param name="identify">TRUE to read the identity now, FALSE to guess the part from the user register until first access</param>
+/// <returns>TRUE if the sensor was found</returns>
+bool Si7021::connect(bool identify){
+	this->bus().begin();
+
+	if(this->probe() != STATUS_OK){
+		return false;
+	}
+
+	//the identity never changes: read it once so telemetry can be tagged without bus traffic.
+	//It also tells which part this is, hence which commands and conversion times to use
+	_identityRead = false;
+	_variant = VARIANT_UNKNOWN;
+	if(identify){
+		this->readIdentity();
+	}
+
+	//the sensor keeps its configuration across MCU resets: take a copy of the registers once,
+	//configuration changes are then single writes
+	if(this->readRegister(SI7021_READ_USER_REGISTER, _userRegister) != STATUS_OK){
+		return false;
+	}
+	if(!_identityRead && (_userRegister & 0x38) == 0){
+		//reserved bits 5:3 read back 1 on a Si70xx, 0 on a HTU21D/SHT21: enough to pick the commands
+		_variant = VARIANT_SHT2X;
+	}
+	if((this->getCapabilities() & SI7021_CAPABILITY_HEATER_LEVEL) == 0){
+		return true;
+	}
+	return this->readRegister(SI7021_READ_HEATER_CONTROL_REGISTER, _heaterRegister) == STATUS_OK;
+}
+
+/// <summary>
+///		Get the part found by begin(). Conversion times, measure() and the temperature read back adapt to it:
+///		on a Si70xx the temperature comes for free with the humidity, on a HTU21D/SHT21 it takes its own conversion.
+///		After begin(config) or reset() the first call reads the identity, until then the part is guessed from its user register.
+/// </summary>
+/// <returns>Variant of the sensor, VARIANT_UNKNOWN if begin() was not called or the sensor could not be identified</returns>
+Si7021::Variant Si7021::getVariant(){
+	this->readIdentity();
+	return _variant;
+}
+
+/// <returns>SI7021_CAPABILITY_ flags of the variant</returns>
+uint8_t Si7021::getCapabilities(){
+	return pgm_read_byte(&SI7021_VARIANTS[_variant][0]);
+}
+
+/// <returns>TRUE if the variant can read back the temperature of a humidity measurement</returns>
+bool Si7021::canReadBack(){
+	return (this->getCapabilities() & SI7021_CAPABILITY_PREVIOUS_TEMPERATURE) != 0;
+}
+
+/// <summary>
+///		Check if the sensor acknowledges its address. Clears the "not present" state: use it to find out if a sensor
+///		that was reported missing is back.
+/// </summary>
+/// <returns>STATUS_OK or STATUS_NOT_PRESENT</returns>
+Si7021::Status Si7021::probe(){
+	_present = true;
+	return this->sendCommand(NULL, 0);
+}
+
+/// <summary>
+///		Check if the sensor is known to be on the bus. Once a sensor fails to acknowledge its address, all calls fail
+///		right away with STATUS_NOT_PRESENT so a missing sensor costs no bus time.
+/// </summary>
+/// <returns>FALSE if the sensor did not answer the last time it was addressed</returns>
+bool Si7021::isPresent(){
+	return _present;
+}
+
+/// <summary>
+///		Get the outcome of the last operation, to find out why a call failed.
+/// </summary>
+/// <returns>Status of the last operation</returns>
+Si7021::Status Si7021::getStatus(){
+	return _status;
+}
+
+
+/// <summary>
+///		Register a function selecting the sensor before each bus transaction, typically by switching an I2C multiplexer
+///		to the channel the sensor is wired to. Lets several sensors sharing the same address be driven by one instance each.
+/// </summary>
+/// <param name="select">Called with channel and context before each transaction. NULL to disable</param>
+/// <param name="channel">Channel of the sensor, passed as is to select</param>
+/// <param name="context">User pointer passed as is to select</param>
+void Si7021::setMuxChannel(Si7021SelectCallback select, uint8_t channel, void* context){
+	_select = select;
+	_channel = channel;
+	_selectContext = context;
+}
+
+/// <summary>
+///		Register functions called around each bus transaction, to share the bus with other tasks under an RTOS.
+///		The bus is only held for the transactions themselves, never during a conversion.
+/// </summary>
+/// <param name="lock">Called before each transaction, must block until the bus is available. NULL to disable</param>
+/// <param name="unlock">Called after each transaction</param>
+/// <param name="context">User pointer passed as is to lock and unlock, eg: the mutex</param>
+void Si7021::setBusLock(Si7021LockCallback lock, Si7021LockCallback unlock, void* context){
+	_lock = lock;
+	_unlock = unlock;
+	_lockContext = context;
+}
+
+/// <returns>Bus given to the constructor. A pointer to our own Wire adapter would dangle in a copy of this object</returns>
+Si7021Bus& Si7021::bus(){
+	return _bus ? *_bus : _wireBus;
+}
+
+/// <summary>Select the sensor's bus or multiplexer channel, if needed</summary>
+void Si7021::select(){
+	if(_select){
+		_select(_channel, _selectContext);
+	}
+}
+
+/// <summary>Select the sensor and write a command to it. Fails without any bus traffic if the sensor is known to be missing</summary>
+/// <param name="bytes">Command and its arguments</param>
+/// <param name="length">Number of bytes to write. 0 just checks that the sensor acknowledges its address</param>
+/// <returns>STATUS_OK, STATUS_NACK, STATUS_NOT_PRESENT, or STATUS_BUSY during a conversion</returns>
+Si7021::Status Si7021::sendCommand(const uint8_t* bytes, uint8_t length){
+
+	if(!_present){
+		return _status = STATUS_NOT_PRESENT;
+	}
+
+	//the sensor NACKs its address until the conversion is done: that would pass for a missing sensor
+	if(_state == STATE_CONVERTING){
+		return _status = STATUS_BUSY;
+	}
+
+	if(_lock){
+		_lock(_lockContext);
+	}
+
+	this->select();
+	uint8_t error = this->bus().write(_address, bytes, length, true);
+	SI7021_COUNT(_stats.transactions++);
+	SI7021_COUNT(_stats.bytes += 1 + length);
+
+	if(_unlock){
+		_unlock(_lockContext);
+	}
+
+	return this->writeStatus(error);
+}
+
+/// <summary>Status of a write from the error code of the bus. Marks the sensor missing if it NACKed its address</summary>
+/// <param name="error">As returned by Si7021Bus::write</param>
+/// <returns>Status of the write</returns>
+Si7021::Status Si7021::writeStatus(uint8_t error){
+	//2: NACK on address, 3: NACK on data, anything else: bus error
+	switch(error){
+		case 0:
+			return _status = STATUS_OK;
+		case 2:
+			_present = false;
+			return _status = STATUS_NOT_PRESENT;
+		default:
+			return _status = STATUS_NACK;
+	}
+}
+
+/// <summary>
+///		Write a command and read its answer with a repeated start, as one bus transaction: the sensor is selected and
+///		the bus locked once, and nothing can come in between
+/// </summary>
+/// <param name="bytes">Command and its arguments</param>
+/// <param name="length">Number of bytes to write</param>
+/// <param name="buffer">Where to store the answer</param>
+/// <param name="quantity">Number of bytes expected</param>
+/// <param name="busError">Where to store the error code of the write, see Si7021Bus::write. NULL if not needed</param>
+/// <returns>Status of the transaction, STATUS_NACK if fewer bytes came back, STATUS_BUSY during a conversion</returns>
+Si7021::Status Si7021::transfer(const uint8_t* bytes, uint8_t length, uint8_t* buffer, const int8_t quantity, uint8_t* busError){
+
+	if(!_present){
+		return _status = STATUS_NOT_PRESENT;
+	}
+
+	//see sendCommand()
+	if(_state == STATE_CONVERTING){
+		return _status = STATUS_BUSY;
+	}
+
+	return this->exchange(bytes, length, buffer, quantity, busError);
 }
 
+/// <summary>The bus side of transfer(), also used for the clock stretched read of a hold master mode conversion</summary>
+/// <param name="bytes">Command and its arguments</param>
+/// <param name="length">Number of bytes to write</param>
+/// <param name="buffer">Where to store the answer</param>
+/// <param name="quantity">Number of bytes expected</param>
+/// <param name="busError">Where to store the error code of the write, see Si7021Bus::write. NULL if not needed</param>
+/// <returns>Status of the transaction, STATUS_NACK if fewer bytes came back</returns>
+Si7021::Status Si7021::exchange(const uint8_t* bytes, uint8_t length, uint8_t* buffer, const int8_t quantity, uint8_t* busError){
+
+	if(_lock){
+		_lock(_lockContext);
+	}
+
+	this->select();
+	uint8_t error = this->bus().write(_address, bytes, length, false);
+	uint8_t received = error == 0 ? this->bus().read(_address, buffer, (uint8_t)quantity) : 0;
+	SI7021_COUNT(_stats.transactions += error == 0 ? 2 : 1);
+	SI7021_COUNT(_stats.bytes += 2 + length + received);
+
+	if(_unlock){
+		_unlock(_lockContext);
+	}
+
+	if(busError){
+		*busError = error;
+	}
+	if(this->writeStatus(error) != STATUS_OK){
+		return _status;
+	}
+	return _status = received < quantity ? STATUS_NACK : STATUS_OK;
+}
+
+/// <summary>Select the sensor and read bytes from it. The bus stays locked until they are out of the bus buffer</summary>
+/// <param name="buffer">Where to store the bytes</param>
+/// <param name="quantity">Number of bytes expected</param>
+/// <returns>Number of bytes actually received, 0 if the sensor NACKed</returns>
+uint8_t Si7021::readBytes(uint8_t* buffer, const int8_t quantity){
+
+	if(_lock){
+		_lock(_lockContext);
+	}
+
+	this->select();
+	uint8_t received = this->bus().read(_address, buffer, (uint8_t)quantity);
+	SI7021_COUNT(_stats.transactions++);
+	SI7021_COUNT(_stats.bytes += 1 + received);
 
-/// <summary>Write a specific instruction to the sensor and return the result</summary>
+	if(_unlock){
+		_unlock(_lockContext);
+	}
+
+	return received;
+}
+
+/// <summary>Time needed by the sensor to execute an instruction at the current resolution</summary>
 /// <param name="instr">The instruction</param>
+/// <returns>Conversion time of the variant, in microseconds</returns>
+uint32_t Si7021::getConversionTime(const uint8_t instr){
+	uint8_t timing = pgm_read_byte(&SI7021_VARIANTS[_variant][1]);
+	switch(instr){
+		case SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE:
+		case SI7021_MEASURE_HUMIDIY_HOLD_MASTER_MODE:
+			return pgm_read_dword(&SI7021_HUMIDITY_CONVERSION_TIME[timing][this->getSensorResolution()]);
+		case SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE:
+		case SI7021_MEASURE_TEMPERATURE_HOLD_MASTER_MODE:
+			return pgm_read_dword(&SI7021_TEMPERATURE_CONVERSION_TIME[timing][this->getSensorResolution()]);
+		default:
+			//reading back the temperature of the previous RH measurement does not trigger a conversion
+			return 0;
+	}
+}
+
+
+/// <summary>
+///		Send an instruction to the sensor and arm the measurement state machine. Returns immediately.
+///		In hold master mode nothing is sent yet: the first update() makes the instruction and its read a single transaction.
+/// </summary>
+/// <param name="instr">The instruction. Must be a no hold master mode instruction so the bus is released during conversion</param>
 /// <param name="returnSize">Number of bytes expected. Due to Arduino library being retarded this must be a signed int</param>  
-/// <returns>Read result</returns>
-uint16_t Si7021::readSensor(const uint8_t instr, const int8_t returnSize){
-	
-	//timeout counter
-	uint8_t timeout = 0;
-	
+/// <param name="readBack">TRUE to also read back the temperature of a humidity measurement once it is done</param>
+/// <returns>STATUS_OK, STATUS_BUSY if a measurement is already in progress, or why the instruction could not be sent</returns>
+Si7021::Status Si7021::startMeasurement(const uint8_t instr, const int8_t returnSize, bool readBack){
+
+	if(_state == STATE_CONVERTING){
+		return _status = STATUS_BUSY;
+	}
+
+	//in hold master mode the instruction and the clock stretched read are one transaction, made by the first update()
+	bool hold = _readyMode == READY_HOLD_MASTER;
+	if(hold && !_present){
+		return _status = STATUS_NOT_PRESENT;
+	}
+
 	//send the instruction
-	Wire.beginTransmission(SI7021_ADDRESS);
-	Wire.write(instr);
-	Wire.endTransmission();
-	
-	//according to the spreadsheet the longest time to wait is 14bit resolution humidity + temp, which is 12 + 10.8ms.
-	//25 is therefore a safe value for all instructions
-	delay(25);
-	
-	//wait for data to be ready
-	Wire.requestFrom(SI7021_ADDRESS, returnSize);
-	while (Wire.available() < returnSize){
-		delay(1);
-		timeout++;
-		if(timeout > SI7021_READ_TIMEOUT){
-			//later down we force the last 2 bit to be 0.
-			//Therefore 1 is not a possible value and can be caught as an error if needed
-			return 1;
+	if(!hold && this->sendCommand(&instr, 1) != STATUS_OK){
+		return _status;
+	}
+
+	this->arm(instr, returnSize, hold, readBack);
+
+	return STATUS_OK;
+}
+
+/// <summary>
+///		Enter STATE_CONVERTING for an instruction the sensor has just received, by us or broadcast to several sensors
+///		at once through a multiplexer (Si7021Array::setMux)
+/// </summary>
+/// <param name="instr">No hold master mode instruction</param>
+/// <param name="returnSize">Number of bytes to read back</param>
+/// <param name="hold">TRUE if the hold master mode version of the instruction was sent</param>
+/// <param name="readBack">TRUE to read back the temperature right after a humidity result, see update()</param>
+void Si7021::arm(const uint8_t instr, const int8_t returnSize, bool hold, bool readBack){
+	_command = instr;
+	_returnSize = returnSize;
+	_readBack = readBack && instr == SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE;
+	_readBackTemperature = SI7021_ERROR_NACK;
+	_discard = false;
+	_conversionTime = this->getConversionTime(instr);
+	if(hold){
+		_nextAttempt = 0;
+	}
+	else{
+		_nextAttempt = (_readyMode == READY_NACK_POLLING && _conversionTime > 0) ? _pollInterval : _conversionTime;
+	}
+	_startTime = this->bus().micros();
+	_status = STATUS_OK;
+	_state = STATE_CONVERTING;
+}
+
+/// <summary>
+///		Advance the measurement state machine. Never blocks: call it from your main loop until it stops returning STATE_CONVERTING.
+///		In no hold master mode the sensor NACKs its read address until the conversion is done, so once the conversion time
+///		has elapsed (or right away in READY_NACK_POLLING mode) a call makes a single read attempt every poll interval
+///		until the data comes in or SI7021_READ_TIMEOUT expires.
+/// </summary>
+/// <returns>Current state of the measurement</returns>
+Si7021::State Si7021::poll(){
+
+	return this->update();
+}
+
+/// <summary>One step of the measurement state machine, see poll()</summary>
+/// <returns>Current state of the measurement</returns>
+Si7021::State Si7021::update(){
+
+	if(_state != STATE_CONVERTING){
+		return _state;
+	}
+
+	uint32_t elapsed = this->bus().micros() - _startTime;
+	if(elapsed < _nextAttempt){
+		return _state;
+	}
+	_nextAttempt = elapsed + _pollInterval;
+
+	//one burst read of the result, decoded in place. The sensor NACKs while no result is available yet
+	uint8_t frame[3];
+	int8_t size = _returnSize;
+	State result;
+	if(_readyMode == READY_HOLD_MASTER){
+		//the hold master mode instruction, then a repeated start: the sensor stretches the clock until it is done
+		const uint8_t instr = _command == SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE ? SI7021_MEASURE_HUMIDIY_HOLD_MASTER_MODE : SI7021_MEASURE_TEMPERATURE_HOLD_MASTER_MODE;
+		result = this->exchange(&instr, 1, frame, size) != STATUS_OK ? STATE_CONVERTING : decodeFrame(frame, size, _result);
+	}
+	else{
+		result = this->readBytes(frame, size) < size ? STATE_CONVERTING : decodeFrame(frame, size, _result);
+	}
+	if(result == STATE_READY){
+		_state = STATE_READY;
+		_status = STATUS_OK;
+
+		//the temperature read back follows right away, as a second transaction, before anything else can reach the sensor
+		if(_readBack){
+			const uint8_t instr = SI7021_READ_TEMPERATURE_FROM_PREVIOUS_RH_MEASUREMENT;
+			_readBackTemperature = SI7021_ERROR_NACK;
+			if(this->transfer(&instr, 1, frame, 2) == STATUS_OK){
+				decodeFrame(frame, 2, _readBackTemperature);
+			}
+			//the humidity is good either way, the caller reads the temperature again on error
+			_status = STATUS_OK;
+		}
+
+#if SI7021_STATS
+		uint32_t latency = this->bus().micros() - _startTime;
+		if(_stats.measurements == 0 || latency < _stats.minLatency){
+			_stats.minLatency = latency;
+		}
+		if(latency > _stats.maxLatency){
+			_stats.maxLatency = latency;
 		}
+		_stats.totalLatency += latency;
+		_stats.measurements++;
+#endif
 	}
-	
-	uint16_t msb = Wire.read();
-	uint8_t lsb = Wire.read();
-	
-	if(returnSize >= 3){
-		Wire.read(); //third byte is the checksum
+	else if(result == STATE_CRC_ERROR){
+		_state = STATE_CRC_ERROR;
+		_status = STATUS_CRC_ERROR;
+		SI7021_COUNT(_stats.crcErrors++);
 	}
-	
+	else if(_readyMode == READY_HOLD_MASTER || elapsed > _conversionTime + SI7021_READ_TIMEOUT * 1000UL){
+		//in hold master mode there is no second chance: the sensor gave up or the I2C peripheral timed out
+		_state = STATE_TIMEOUT;
+		_status = STATUS_TIMEOUT;
+		SI7021_COUNT(_stats.timeouts++);
+	}
+	else{
+		SI7021_COUNT(_stats.pollAttempts++);
+	}
+
+	//nobody waits for this result any more, see cancelMeasurement()
+	if(_state != STATE_CONVERTING && _discard){
+		_discard = false;
+		_state = STATE_IDLE;
+	}
+
+	//cleared before the call so the callback can start the next measurement
+	if(_state != STATE_CONVERTING && _completion){
+		Si7021CompletionCallback completion = _completion;
+		_completion = NULL;
+		completion(*this, _completionContext);
+	}
+
+	return _state;
+}
+
+/// <summary>Check and decode a result frame in place: MSB, LSB and, when returnSize is 3, the checksum of both</summary>
+/// <param name="frame">Bytes as read from the sensor</param>
+/// <param name="returnSize">2 or 3</param>
+/// <param name="value">Decoded result, left untouched on error</param>
+/// <returns>STATE_READY, or STATE_CRC_ERROR if the checksum did not match</returns>
+Si7021::State Si7021::decodeFrame(const uint8_t* frame, const int8_t returnSize, uint16_t& value){
+
+#if SI7021_CRC_MODE != SI7021_CRC_NONE
+	//third byte is the checksum
+	if(returnSize >= 3 && crc8(frame, 2) != frame[2]){
+		return STATE_CRC_ERROR;
+	}
+#else
+	(void)returnSize;
+#endif
+
 	//a humidity measurement will always return XXXXXX10 in the LSB field.
 	//Clear the last 2 bits of lsb. Little quirk of the sensor!
-	lsb &= 0xFC;
-	
-	return (uint16_t)((msb << 8) | lsb);
+	value = (uint16_t)((frame[0] << 8) | (frame[1] & 0xFC));
+	return STATE_READY;
+}
+
+/// <summary>Wait for a conversion in the blocking API</summary>
+/// <param name="us">Time to wait, in microseconds</param>
+void Si7021::pause(uint32_t us){
+	SI7021_COUNT(_stats.waitTime += us);
+	this->bus().wait(us);
+}
+
+/// <summary>
+///		Write a specific instruction to the sensor and return the result. Blocks until the conversion is done.
+///		A non-blocking measurement in progress is waited out first, its result stays available to getResult()
+/// </summary>
+/// <param name="instr">The instruction</param>
+/// <param name="returnSize">Number of bytes expected. Due to Arduino library being retarded this must be a signed int</param>  
+/// <param name="value">Read result</param>
+/// <param name="temperature">Where to store the temperature read back of a humidity measurement, see startMeasurement(). NULL if not needed</param>
+/// <returns>Status of the measurement</returns>
+Si7021::Status Si7021::readSensor(const uint8_t instr, const int8_t returnSize, uint16_t& value, uint16_t* temperature){
+
+	//the sensor NACKs its address until the conversion in progress ends
+	while(this->update() == STATE_CONVERTING){
+	}
+
+	//the pending result, eg: a continuous sample or one the caller hasn't collected yet
+	State state = _state;
+	uint8_t command = _command;
+	uint16_t result = _result;
+	bool readBack = _readBack;
+	uint16_t readBackTemperature = _readBackTemperature;
+	_state = STATE_IDLE;
+
+	Status status = this->convert(instr, returnSize, value, temperature);
+
+	if(state != STATE_IDLE){
+		_state = state;
+		_command = command;
+		_result = result;
+		_readBack = readBack;
+		_readBackTemperature = readBackTemperature;
+	}
+	return status;
+}
+
+/// <summary>One blocking conversion, see readSensor()</summary>
+/// <param name="instr">The instruction</param>
+/// <param name="returnSize">Number of bytes expected</param>  
+/// <param name="value">Read result</param>
+/// <param name="temperature">See readSensor()</param>
+/// <returns>Status of the measurement</returns>
+Si7021::Status Si7021::convert(const uint8_t instr, const int8_t returnSize, uint16_t& value, uint16_t* temperature){
+
+	if(this->startMeasurement(instr, returnSize, temperature != NULL) != STATUS_OK){
+		return _status;
+	}
+
+	while(this->update() == STATE_CONVERTING){
+		uint32_t elapsed = this->bus().micros() - _startTime;
+		if(_nextAttempt > elapsed){
+			this->pause(_nextAttempt - elapsed);
+		}
+	}
+
+	_state = STATE_IDLE;
+	value = _result;
+	if(temperature){
+		*temperature = _readBackTemperature;
+	}
+	return _status;
+}
+
+/// <summary>Write an instruction that does not trigger a conversion and read its result right away. Leaves the measurement state machine untouched</summary>
+/// <param name="instr">The instruction</param>
+/// <param name="returnSize">Number of bytes expected</param>  
+/// <param name="value">Read result</param>
+/// <returns>Status of the read</returns>
+Si7021::Status Si7021::readImmediate(const uint8_t instr, const int8_t returnSize, uint16_t& value){
+
+	uint8_t frame[3];
+	if(this->transfer(&instr, 1, frame, returnSize) == STATUS_OK && decodeFrame(frame, returnSize, value) != STATE_READY){
+		_status = STATUS_CRC_ERROR;
+	}
+	return _status;
+}
+
+/// <summary>Turn the status of a read into the code returned by the raw API</summary>
+/// <param name="status">Status of the read</param>
+/// <param name="value">Read result</param>
+/// <returns>value, or one of the SI7021_ERROR_ codes</returns>
+uint16_t Si7021::toCode(Status status, uint16_t value){
+	//later down we force the last 2 bit to be 0.
+	//Therefore 1, 2 and 3 are not possible values and can be caught as errors if needed
+	switch(status){
+		case STATUS_OK:
+			return value;
+		case STATUS_TIMEOUT:
+			return SI7021_ERROR_TIMEOUT;
+		case STATUS_CRC_ERROR:
+			return SI7021_ERROR_CRC;
+		default:
+			return SI7021_ERROR_NACK;
+	}
+}
+
+/// <summary>
+///		Measure the humidity and read back the temperature converted along with it. Costs a single conversion plus a short read.
+///		On a part without temperature read back (VARIANT_SHT2X) the temperature is measured right after.
+/// </summary>
+/// <param name="reading">Raw codes and timestamp of the measurement. Left untouched on error</param>
+/// <returns>STATUS_OK, or what went wrong</returns>
+Si7021::Status Si7021::measure(Reading& reading){
+
+	uint16_t rh, t;
+
+	if(this->getCapabilities() & SI7021_CAPABILITY_PREVIOUS_TEMPERATURE){
+		//both come in with the humidity result, the temperature is only read again if that part failed
+		if(this->readSensor(SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE, (uint8_t)3, rh, &t) != STATUS_OK){
+			return _status;
+		}
+		if(SI7021_IS_ERROR(t) && this->readImmediate(SI7021_READ_TEMPERATURE_FROM_PREVIOUS_RH_MEASUREMENT, (uint8_t)2, t) != STATUS_OK){
+			return _status;
+		}
+	}
+	else{
+		if(this->readSensor(SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE, (uint8_t)3, rh) != STATUS_OK){
+			return _status;
+		}
+		if(this->readSensor(SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE, (uint8_t)3, t) != STATUS_OK){
+			return _status;
+		}
+	}
+
+	reading.humidityCode = rh;
+	reading.temperatureCode = t;
+	reading.timestamp = this->bus().millis();
+	return STATUS_OK;
+}
+
+/// <summary>
+///		Choose how the end of a conversion is detected.
+///		READY_TIMED (default) waits for the datasheet worst case conversion time of the current resolution before reading.
+///		READY_NACK_POLLING tries to read every pollInterval from the start: the result comes in as soon as the sensor
+///		is done, often well below the worst case, at the cost of a few NACKed address bytes on the bus.
+///		READY_HOLD_MASTER uses the hold master mode instructions: the read starts right away and the sensor stretches
+///		the clock until the conversion is done. Lowest latency with a single transaction, but poll() blocks for the
+///		conversion time and the bus is busy meanwhile. Only available when SI7021_HAS_CLOCK_STRETCHING is set.
+/// </summary>
+/// <param name="mode">READY_TIMED, READY_NACK_POLLING or READY_HOLD_MASTER</param>
+/// <param name="pollInterval">Time between two read attempts, in microseconds</param>
+/// <returns>FALSE if the mode is not supported on this platform, or a conversion is in progress</returns>
+bool Si7021::setReadyMode(ReadyMode mode, uint16_t pollInterval){
+#if !SI7021_HAS_CLOCK_STRETCHING
+	if(mode == READY_HOLD_MASTER){
+		return false;
+	}
+#endif
+	//the conversion in progress was started for the current mode
+	if(_state == STATE_CONVERTING){
+		return false;
+	}
+	_readyMode = mode;
+	_pollInterval = pollInterval;
+	return true;
+}
+
+#if SI7021_STATS
+/// <summary>
+///		Get the bus and timing counters of this sensor since construction or resetStats(), to size sampling schedules
+///		or spot a failing sensor. Only available when SI7021_STATS is set.
+/// </summary>
+/// <returns>Counters, updated in place</returns>
+const Si7021::Stats& Si7021::getStats(){
+	return _stats;
+}
+
+/// <summary>Clear the bus and timing counters</summary>
+void Si7021::resetStats(){
+	memset(&_stats, 0, sizeof(_stats));
+}
+#endif
+
+/// <returns>How the end of a conversion is detected, see setReadyMode</returns>
+Si7021::ReadyMode Si7021::getReadyMode(){
+	return _readyMode;
+}
+
+/// <summary>
+///		Start a relative humidity measurement without blocking. A temperature measurement is made at the same time and can
+///		be read afterwards with getTemperatureFromPreviousHumidityMeasurement().
+/// 	<seealso cref="Si7021::poll"/>  
+/// </summary>
+/// <param name="readBack">
+///		TRUE to have poll() read back that temperature right after the humidity result, see getReadBackTemperatureRaw().
+///		Ignored by parts that can't read it back (VARIANT_SHT2X)
+/// </param>
+/// <returns>FALSE if a measurement is already in progress or the sensor did not answer, see getStatus()</returns>
+bool Si7021::startHumidityMeasurement(bool readBack){
+	return this->startMeasurement(SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE, (uint8_t)3, readBack && this->canReadBack()) == STATUS_OK;
+}
+
+/// <summary>
+///		Start a temperature measurement without blocking.
+/// 	<seealso cref="Si7021::poll"/>  
+/// </summary>
+/// <returns>FALSE if a measurement is already in progress or the sensor did not answer, see getStatus()</returns>
+bool Si7021::startTemperatureMeasurement(){
+	return this->startMeasurement(SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE, (uint8_t)3) == STATUS_OK;
+}
+
+/// <summary>
+///		Start a relative humidity measurement and have callback called from poll() once it completes. Call poll() from
+///		the main loop, a scheduler tick or a timer task, but not from an interrupt: it uses the Wire library.
+///		In the callback use getStatus() then getResult() or getRawResult(), and possibly start the next measurement.
+/// </summary>
+/// <param name="callback">Called once, on success, timeout or checksum error</param>
+/// <param name="context">User pointer passed as is to callback</param>
+/// <returns>FALSE if the measurement could not be started, see getStatus(). callback is not called in that case</returns>
+bool Si7021::requestHumidity(Si7021CompletionCallback callback, void* context){
+	if(!this->startHumidityMeasurement()){
+		return false;
+	}
+	_completion = callback;
+	_completionContext = context;
+	return true;
+}
+
+/// <summary>
+///		Start a temperature measurement and have callback called from poll() once it completes.
+/// 	<seealso cref="Si7021::requestHumidity"/>  
+/// </summary>
+/// <param name="callback">Called once, on success, timeout or checksum error</param>
+/// <param name="context">User pointer passed as is to callback</param>
+/// <returns>FALSE if the measurement could not be started, see getStatus(). callback is not called in that case</returns>
+bool Si7021::requestTemperature(Si7021CompletionCallback callback, void* context){
+	if(!this->startTemperatureMeasurement()){
+		return false;
+	}
+	_completion = callback;
+	_completionContext = context;
+	return true;
+}
+
+/// <summary>
+///		Get the state of the measurement without advancing it, unlike poll(): no bus traffic.
+/// </summary>
+/// <returns>Current state of the measurement</returns>
+Si7021::State Si7021::getState(){
+	return _state;
+}
+
+/// <summary>
+///		Get the time of the clock the driver runs on: millis() with Wire, the bus's own clock otherwise (eg: Si7021Sim).
+/// </summary>
+/// <returns>Time in milliseconds</returns>
+uint32_t Si7021::getMillis(){
+	return this->bus().millis();
+}
+
+/// <summary>
+///		Get the time of the clock the driver runs on, see getMillis().
+/// </summary>
+/// <returns>Time in microseconds</returns>
+uint32_t Si7021::getMicros(){
+	return this->bus().micros();
+}
+
+/// <summary>
+///		Busy wait on the clock the driver runs on, see getMillis().
+/// </summary>
+/// <param name="us">Time to wait, in microseconds</param>
+void Si7021::wait(uint32_t us){
+	this->bus().wait(us);
+}
+
+/// <summary>
+///		Get how long poll() has nothing to do for the measurement in progress, eg: to sleep meanwhile.
+/// </summary>
+/// <returns>Time until the next read attempt, in microseconds. 0 if poll() should be called right away or nothing is in progress</returns>
+uint32_t Si7021::getWaitTime(){
+	if(_state != STATE_CONVERTING){
+		return 0;
+	}
+	uint32_t elapsed = this->bus().micros() - _startTime;
+	return _nextAttempt > elapsed ? _nextAttempt - elapsed : 0;
+}
+
+/// <summary>
+///		Account for time the clock missed, eg: a deep sleep that stops the timer behind micros(), so the measurement
+///		in progress is not read too late nor timed out too soon.
+/// </summary>
+/// <param name="us">Time that actually went by on top of what the clock saw, in microseconds</param>
+void Si7021::addElapsedTime(uint32_t us){
+	_startTime -= us;
+}
+
+/// <returns>Worst case conversion time of the last measurement started, in microseconds</returns>
+uint32_t Si7021::getLastConversionTime(){
+	return _conversionTime;
+}
+
+/// <summary>
+///		Check if the result of the measurement started with startHumidityMeasurement() or startTemperatureMeasurement() is available.
+/// </summary>
+/// <returns>TRUE if getResult() can be called</returns>
+bool Si7021::isReady(){
+	return this->poll() == STATE_READY;
+}
+
+/// <summary>
+///		Drop the result of the non-blocking measurement in progress, and its callback. The sensor ends its conversion
+///		regardless and NACKs its address until then: the state machine stays in STATE_CONVERTING meanwhile, so that is
+///		not taken for a missing sensor, and poll() returns to STATE_IDLE once the result is in. A result already in is
+///		dropped right away.
+/// </summary>
+void Si7021::cancelMeasurement(){
+	//in hold master mode the instruction and its read are one transaction: nothing is pending on the sensor between calls
+	if(_state == STATE_CONVERTING && _readyMode != READY_HOLD_MASTER){
+		_discard = true;
+		_readBack = false;
+		_completion = NULL;
+	}
+	else{
+		_state = STATE_IDLE;
+	}
+}
+
+/// <summary>
+///		Get the result of the last non-blocking measurement and return the state machine to idle.
+///		A blocking call made in between (eg: measure()) waits for the conversion to end and leaves the result here.
+/// </summary>
+/// <returns>Relative Humidity in percent or Temperature in Celcius, depending on the measurement that was started. NAN if no result is available</returns>
+float Si7021::getResult(){
+
+	if(_state != STATE_READY){
+		return NAN;
+	}
+
+	_state = STATE_IDLE;
+
+	if(_command == SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE){
+		return convertHumidity(_result);
+	}
+	else{
+		return convertTemperature(_result);
+	}
+}
+
+/// <summary>
+///		Get the raw sensor code of the last non-blocking measurement and return the state machine to idle.
+///		Convert it with convertHumidity/convertTemperature or their integer counterparts when needed.
+/// </summary>
+/// <returns>Raw code, one of the SI7021_ERROR_ codes if no valid result is available</returns>
+uint16_t Si7021::getRawResult(){
+
+	if(_state == STATE_CRC_ERROR){
+		return SI7021_ERROR_CRC;
+	}
+	if(_state == STATE_TIMEOUT){
+		return SI7021_ERROR_TIMEOUT;
+	}
+	if(_state != STATE_READY){
+		return SI7021_ERROR_NACK;
+	}
+
+	_state = STATE_IDLE;
+	return _result;
+}
+
+/// <summary>
+///		Get the temperature read back by poll() right after the humidity result of startHumidityMeasurement(true).
+///		Unlike getTemperatureFromPreviousHumidityMeasurementRaw() it never uses the bus.
+/// </summary>
+/// <returns>Raw temperature code, SI7021_ERROR_NACK if the last measurement did not read one back</returns>
+uint16_t Si7021::getReadBackTemperatureRaw(){
+	return _readBack ? _readBackTemperature : SI7021_ERROR_NACK;
 }
 
 /// <summary>
 ///		Measure the temperature. Since reading humidity also forces a temperature measurement, you shouldn't use this function unless you just want the temperature
 /// 	<seealso cref="Si7021::getTemperatureFromPreviousHumidityMeasurement"/>  
 /// </summary>
-/// <returns>Temperature, in Celcius</returns>
+/// <returns>Temperature, in Celcius. NAN on error, see getStatus()</returns>
 float Si7021::measureTemperature(){
-	uint16_t dword = readSensor(SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE, (uint8_t)3);
-	return 175.25f * dword / 65536.0f - 46.85f;
+	uint16_t code = this->measureTemperatureRaw();
+	return SI7021_IS_ERROR(code) ? NAN : convertTemperature(code);
 }
 
 /// <summary>
 ///		Measure the temperature. Since reading humidity also forces a temperature measurement, you shouldn't use this function unless you just want the temperature
 /// 	<seealso cref="Si7021::getTemperatureFromPreviousHumidityMeasurementF"/>  
 /// </summary>
-/// <returns>Temperature, in Fahrenheit </returns>
+/// <returns>Temperature, in Fahrenheit. NAN on error, see getStatus()</returns>
 float Si7021::measureTemperatureF(){
-	return this->measureTemperature() * 1.8f + 32.0f;
+	uint16_t code = this->measureTemperatureRaw();
+	return SI7021_IS_ERROR(code) ? NAN : convertTemperatureF(code);
+}
+
+/// <summary>
+///		Measure the temperature. Since reading humidity also forces a temperature measurement, you shouldn't use this function unless you just want the temperature
+/// 	<seealso cref="Si7021::getTemperatureFromPreviousHumidityMeasurementK"/>  
+/// </summary>
+/// <returns>Temperature, in Kelvin. NAN on error, see getStatus()</returns>
+float Si7021::measureTemperatureK(){
+	uint16_t code = this->measureTemperatureRaw();
+	return SI7021_IS_ERROR(code) ? NAN : convertTemperatureK(code);
 }
 
 /// <summary>
 ///		Measure the humidy.
 /// </summary>
-/// <returns>Relative Humidity, in percent</returns>
+/// <returns>Relative Humidity, in percent. NAN on error, see getStatus()</returns>
 float Si7021::measureHumidity(){
-	uint16_t dword = readSensor(SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE, (uint8_t)3);
-	return 125.0f * dword / 65536.0f - 6.0f;
+	uint16_t code = this->measureHumidityRaw();
+	return SI7021_IS_ERROR(code) ? NAN : convertHumidity(code);
 }
 
+/// <summary>
+///		Measure the humidity and get the temperature that was converted along with it.
+///		Costs a single conversion plus a short read back of the temperature.
+/// </summary>
+/// <param name="humidity">Relative Humidity, in percent</param>
+/// <param name="temperature">Temperature, in Celcius</param>
+/// <returns>FALSE if the sensor did not answer or the data was corrupted, see getStatus()</returns>
+bool Si7021::measureHumidityAndTemperature(float& humidity, float& temperature){
+
+	Reading reading;
+	if(this->measure(reading) != STATUS_OK){
+		return false;
+	}
+
+	humidity = reading.getHumidity();
+	temperature = reading.getTemperature();
+	return true;
+}
 
 /// <summary>
 ///		Each time a relative humidity measurement is made a temperature measurement is also made for the purposes of
 ///		temperature compensation of the relative humidity measurement. If the temperature value is required, it can be
 ///		read using this function; this avoids having to perform a second temperature measurement. 
 /// </summary>
-/// <returns>Temperature, in Celcius</returns>
+/// <returns>Temperature, in Celcius. NAN on error, see getStatus()</returns>
 float Si7021::getTemperatureFromPreviousHumidityMeasurement(){
-	uint16_t dword = readSensor(SI7021_READ_TEMPERATURE_FROM_PREVIOUS_RH_MEASUREMENT, (uint8_t)2);
-	return 175.25f * dword / 65536.0f - 46.85f;
+	uint16_t code = this->getTemperatureFromPreviousHumidityMeasurementRaw();
+	return SI7021_IS_ERROR(code) ? NAN : convertTemperature(code);
 }
 
 /// <summary>
@@ -113,144 +1039,459 @@ float Si7021::getTemperatureFromPreviousHumidityMeasurement(){
 ///		temperature compensation of the relative humidity measurement. If the temperature value is required, it can be
 ///		read using this function; this avoids having to perform a second temperature measurement. 
 /// </summary>
-/// <returns>Temperature, in Fahrenheit</returns>
+/// <returns>Temperature, in Fahrenheit. NAN on error, see getStatus()</returns>
 float Si7021::getTemperatureFromPreviousHumidityMeasurementF(){
-	return getTemperatureFromPreviousHumidityMeasurementF() * 1.8f + 32.0f;
+	uint16_t code = this->getTemperatureFromPreviousHumidityMeasurementRaw();
+	return SI7021_IS_ERROR(code) ? NAN : convertTemperatureF(code);
+}
+
+/// <summary>
+///		Each time a relative humidity measurement is made a temperature measurement is also made for the purposes of
+///		temperature compensation of the relative humidity measurement. If the temperature value is required, it can be
+///		read using this function; this avoids having to perform a second temperature measurement. 
+/// </summary>
+/// <returns>Temperature, in Kelvin. NAN on error, see getStatus()</returns>
+float Si7021::getTemperatureFromPreviousHumidityMeasurementK(){
+	uint16_t code = this->getTemperatureFromPreviousHumidityMeasurementRaw();
+	return SI7021_IS_ERROR(code) ? NAN : convertTemperatureK(code);
+}
+
+/// <summary>
+///		Measure the temperature without any floating point math.
+/// 	<seealso cref="Si7021::measureTemperature"/>  
+/// </summary>
+/// <returns>Temperature, in hundredths of a degree Celcius. SI7021_TEMPERATURE_CENTI_ERROR on error</returns>
+int16_t Si7021::measureTemperatureCenti(){
+	uint16_t code = this->measureTemperatureRaw();
+	return SI7021_IS_ERROR(code) ? SI7021_TEMPERATURE_CENTI_ERROR : convertTemperatureCenti(code);
+}
+
+/// <summary>
+///		Read the temperature of the previous humidity measurement without any floating point math.
+/// 	<seealso cref="Si7021::getTemperatureFromPreviousHumidityMeasurement"/>  
+/// </summary>
+/// <returns>Temperature, in hundredths of a degree Celcius. SI7021_TEMPERATURE_CENTI_ERROR on error</returns>
+int16_t Si7021::getTemperatureFromPreviousHumidityMeasurementCenti(){
+	uint16_t code = this->getTemperatureFromPreviousHumidityMeasurementRaw();
+	return SI7021_IS_ERROR(code) ? SI7021_TEMPERATURE_CENTI_ERROR : convertTemperatureCenti(code);
+}
+
+/// <summary>
+///		Measure the humidity without any floating point math.
+/// 	<seealso cref="Si7021::measureHumidity"/>  
+/// </summary>
+/// <returns>Relative Humidity, in hundredths of a percent (0 to 10000). SI7021_HUMIDITY_CENTI_ERROR on error</returns>
+uint16_t Si7021::measureHumidityCenti(){
+	uint16_t code = this->measureHumidityRaw();
+	return SI7021_IS_ERROR(code) ? SI7021_HUMIDITY_CENTI_ERROR : convertHumidityCenti(code);
+}
+
+/// <summary>
+///		Measure the temperature and return the code of the sensor as is.
+/// </summary>
+/// <returns>Raw temperature code, one of the SI7021_ERROR_ codes on error</returns>
+uint16_t Si7021::measureTemperatureRaw(){
+	uint16_t value = 0;
+	Status status = this->readSensor(SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE, (uint8_t)3, value);
+	return toCode(status, value);
+}
+
+/// <summary>
+///		Read back the temperature of the previous humidity measurement and return the code of the sensor as is.
+///		Parts that can't read it back (VARIANT_SHT2X) make a temperature measurement instead.
+/// </summary>
+/// <returns>Raw temperature code, one of the SI7021_ERROR_ codes on error</returns>
+uint16_t Si7021::getTemperatureFromPreviousHumidityMeasurementRaw(){
+	//not supported by the HTU21D/SHT21: measure it instead
+	if((this->getCapabilities() & SI7021_CAPABILITY_PREVIOUS_TEMPERATURE) == 0){
+		return this->measureTemperatureRaw();
+	}
+
+	//the value is already latched in the sensor: no need to wait for a conversion
+	uint16_t value = 0;
+	Status status = this->readImmediate(SI7021_READ_TEMPERATURE_FROM_PREVIOUS_RH_MEASUREMENT, (uint8_t)2, value);
+	return toCode(status, value);
 }
 
 /// <summary>
-///		Soft reset of the chip.
+///		Measure the humidity and return the code of the sensor as is.
+/// </summary>
+/// <returns>Raw humidity code, one of the SI7021_ERROR_ codes on error</returns>
+uint16_t Si7021::measureHumidityRaw(){
+	uint16_t value = 0;
+	Status status = this->readSensor(SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE, (uint8_t)3, value);
+	return toCode(status, value);
+}
+
+/// <summary>Convert a raw temperature code</summary>
+/// <param name="code">Raw code from the sensor</param>
+/// <returns>Temperature, in Celcius</returns>
+float Si7021::convertTemperature(uint16_t code){
+	//constants are folded so this is a single multiply-add
+	return code * (175.72f / 65536.0f) - 46.85f;
+}
+
+/// <summary>Convert a raw temperature code straight to Fahrenheit, without going through Celcius</summary>
+/// <param name="code">Raw code from the sensor</param>
+/// <returns>Temperature, in Fahrenheit</returns>
+float Si7021::convertTemperatureF(uint16_t code){
+	//(175.72 * code / 65536 - 46.85) * 1.8 + 32
+	return code * (175.72f * 1.8f / 65536.0f) + (32.0f - 46.85f * 1.8f);
+}
+
+/// <summary>Convert a raw temperature code straight to Kelvin, without going through Celcius</summary>
+/// <param name="code">Raw code from the sensor</param>
+/// <returns>Temperature, in Kelvin</returns>
+float Si7021::convertTemperatureK(uint16_t code){
+	return code * (175.72f / 65536.0f) + (273.15f - 46.85f);
+}
+
+/// <summary>Convert a raw humidity code</summary>
+/// <param name="code">Raw code from the sensor</param>
+/// <returns>Relative Humidity, in percent</returns>
+float Si7021::convertHumidity(uint16_t code){
+	return code * (125.0f / 65536.0f) - 6.0f;
+}
+
+/// <summary>Convert a raw temperature code with integer math only: 17572 * code / 65536 - 4685, rounded</summary>
+/// <param name="code">Raw code from the sensor</param>
+/// <returns>Temperature, in hundredths of a degree Celcius</returns>
+int16_t Si7021::convertTemperatureCenti(uint16_t code){
+	//17572 * 65535 fits in 32 bits
+	return (int16_t)((17572UL * code + 32768UL) >> 16) - 4685;
+}
+
+/// <summary>Convert a raw humidity code with integer math only: 12500 * code / 65536 - 600, rounded</summary>
+/// <param name="code">Raw code from the sensor</param>
+/// <returns>Relative Humidity, in hundredths of a percent. Values out of the 0-100% range are clamped, as recommended by the datasheet</returns>
+uint16_t Si7021::convertHumidityCenti(uint16_t code){
+	uint16_t centi = (uint16_t)((12500UL * code + 32768UL) >> 16);
+	if(centi < 600){
+		return 0;
+	}
+	centi -= 600;
+	return centi > 10000 ? 10000 : centi;
+}
+
+/// <summary>CRC-8 checksum used by the sensor: polynomial 0x31, initialized to 0x00</summary>
+/// <param name="data">Bytes to checksum</param>
+/// <param name="length">Number of bytes</param>
+/// <param name="crc">Checksum of the preceding bytes, to compute it in several steps</param>
+/// <returns>Checksum</returns>
+uint8_t Si7021::crc8(const uint8_t* data, uint8_t length, uint8_t crc){
+	for(uint8_t i = 0; i < length; i++){
+#if SI7021_CRC_MODE == SI7021_CRC_TABLE
+		crc = pgm_read_byte(&SI7021_CRC_TABLE_DATA[crc ^ data[i]]);
+#else
+		crc ^= data[i];
+		for(uint8_t bit = 0; bit < 8; bit++){
+			crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+		}
+#endif
+	}
+	return crc;
+}
+
+/// <summary>
+///		Soft reset of the chip. Returns as soon as the sensor answers again, SI7021_RESET_TIME at most.
 /// </summary>
 void Si7021::reset(){
-	Wire.beginTransmission(SI7021_ADDRESS);
-	Wire.write(SI7021_RESET);
-	Wire.endTransmission();
-	delay(15); //datasheet specifies device takes up to 15ms (5ms typical) before going back live
+	const uint8_t cmd = SI7021_RESET;
+
+	//give a sensor reported missing another chance
+	_present = true;
+
+	//the sensor NACKs its address until the conversion in progress ends: that would pass for a missing sensor.
+	//The reset discards the result anyway
+	while(this->update() == STATE_CONVERTING){
+	}
+	_state = STATE_IDLE;
+	if(this->sendCommand(&cmd, 1) != STATUS_OK){
+		return;
+	}
+
+	//reset restores the default configuration
+	_userRegister = SI7021_USER_REGISTER_DEFAULT;
+	_heaterRegister = SI7021_HEATER_CONTROL_REGISTER_DEFAULT;
+
+	//identity is read again on next access
+	_identityRead = false;
+
+	//datasheet specifies device takes up to 15ms (5ms typical) before going back live
+	this->waitReady(SI7021_RESET_TIME);
+}
+
+/// <summary>Wait for the sensor to acknowledge its address again, eg: after a reset, trying every poll interval</summary>
+/// <param name="timeout">Maximum wait, in microseconds</param>
+/// <returns>FALSE if the sensor is still silent after timeout, it is then reported missing</returns>
+bool Si7021::waitReady(uint32_t timeout){
+
+	uint32_t start = this->bus().micros();
+	do{
+		this->bus().wait(_pollInterval);
+		//a NACK on address while booting is not a missing sensor yet
+		_present = true;
+		if(this->sendCommand(NULL, 0) == STATUS_OK){
+			return true;
+		}
+	} while(this->bus().micros() - start < timeout);
+
+	return false;
 }
 
 /// <summary>
-///		Read the 64 bit serial number of the Si7021 sensor
-///		Because 64 bit is expensive this should be used for debugging purposes only.
+///		Read the firmware revision and the electronic ID from the sensor, once, and identify the part from them.
+///		Done by begin(), or on the first access after begin(config) or reset(). A transient failure, eg: a conversion in progress
+///		or a corrupted frame, leaves the part as it was and the read is tried again on the next access.
 /// </summary>
-/// <returns>Serial number</returns>
-uint64_t Si7021::getSerialNumber(){
-	
-	uint64_t serialNo = 0ULL;
-	uint8_t buffer = 0x00;
+void Si7021::readIdentity(){
+	if(_identityRead){
+		return;
+	}
 
-	
-	Wire.beginTransmission(SI7021_ADDRESS);
-	Wire.write(0xFA);
-	Wire.write(0X0F);
-	Wire.endTransmission();
-
-	//4 byte + CRC for each
-	Wire.requestFrom(SI7021_ADDRESS, 8);
-	while (Wire.available() >= 2){
-		buffer = Wire.read();
-		serialNo = (serialNo << 8) | buffer;
-		Wire.read(); //discard checksum
+	//the sensor NACKs its address until the conversion in progress ends, the result stays readable
+	while(this->update() == STATE_CONVERTING){
 	}
+
+	//revision 1.0 and 2.0 share their command set and timing. Compatible parts NACK the command itself
+	bool unsupported = false;
+	if(this->readFirmwareVersion(unsupported) != STATUS_OK && !unsupported){
+		return;
+	}
+
+	Status serial = this->readSerialNumber();
+	if(serial != STATUS_OK){
+		//still good enough to tell a compatible part apart. One without an electronic ID is done
+		if(unsupported){
+			_variant = VARIANT_SHT2X;
+			_identityRead = serial == STATUS_NACK;
+		}
+		return;
+	}
+	_identityRead = true;
+
+	//SNB_3 is the device ID
+	switch((uint8_t)(_serialB >> 24)){
+		case 0x0D:
+			_variant = VARIANT_SI7013;
+			break;
+		case 0x14:
+			_variant = VARIANT_SI7020;
+			break;
+		case 0x15:
+			_variant = VARIANT_SI7021;
+			break;
+		default:
+			_variant = unsupported ? VARIANT_SHT2X : VARIANT_SI70XX;
+			break;
+	}
+	_status = STATUS_OK;
+}
+
+/// <summary>
+///		Read the 64 bit serial number of the Si7021 sensor and check its checksums.
+/// </summary>
+/// <returns>Status of the read. On error the cached serial number is 0</returns>
+Si7021::Status Si7021::readSerialNumber(){
 	
-	Wire.beginTransmission(SI7021_ADDRESS);
-	Wire.write(0xFC);
-	Wire.write(0xC9);
-	Wire.endTransmission();
-
-	//4 byte + CRC for each
-	Wire.requestFrom(SI7021_ADDRESS, 8);
-	while (Wire.available() >= 2){
-		buffer = Wire.read();
-		serialNo = (serialNo << 8) | buffer;
-		Wire.read(); //discard checksum
+	uint8_t sna[8];
+	uint8_t snb[6];
+	const uint8_t firstAccess[2] = { 0xFA, 0x0F };
+	const uint8_t secondAccess[2] = { 0xFC, 0xC9 };
+
+	_serialA = 0;
+	_serialB = 0;
+
+	//1st access: SNA_3, CRC, SNA_2, CRC, SNA_1, CRC, SNA_0, CRC
+	if(this->transfer(firstAccess, 2, sna, 8) != STATUS_OK){
+		return _status;
 	}
+
+	//2nd access: SNB_3, SNB_2, CRC, SNB_1, SNB_0, CRC
+	if(this->transfer(secondAccess, 2, snb, 6) != STATUS_OK){
+		return _status;
+	}
+
+#if SI7021_CRC_MODE != SI7021_CRC_NONE
+	//each checksum covers all the serial number bytes of the access read so far
+	uint8_t crc = 0x00;
+	for(uint8_t i = 0; i < 8; i += 2){
+		crc = crc8(&sna[i], 1, crc);
+		if(crc != sna[i + 1]){
+			return _status = STATUS_CRC_ERROR;
+		}
+	}
+	crc = crc8(&snb[0], 2);
+	if(crc != snb[2]){
+		return _status = STATUS_CRC_ERROR;
+	}
+	crc = crc8(&snb[3], 2, crc);
+	if(crc != snb[5]){
+		return _status = STATUS_CRC_ERROR;
+	}
+#endif
+
+	//kept as two 32 bit halves: 64 bit shifts are expensive on 8 bit MCUs
+	_serialA = ((uint32_t)sna[0] << 24) | ((uint32_t)sna[2] << 16) | ((uint16_t)sna[4] << 8) | sna[6];
+	_serialB = ((uint32_t)snb[0] << 24) | ((uint32_t)snb[1] << 16) | ((uint16_t)snb[3] << 8) | snb[4];
 	
-	return serialNo;
+	return _status = STATUS_OK;
 	
 }
 
 /// <summary>
-///		Get the firmware revision. 0xFF = Firmware version 1.0 0x20 = Firmware version 2.0
-///	</summary>
-/// <returns>Firmware version</returns>
-uint8_t Si7021::getFirmwareVersion() {
-	uint8_t buffer = 0x00;
+///		Read the firmware revision from the sensor.
+/// </summary>
+/// <param name="unsupported">Set to TRUE if the sensor NACKed the command: it doesn't have one</param>
+/// <returns>Status of the read. On error the cached firmware revision is 0x00</returns>
+Si7021::Status Si7021::readFirmwareVersion(bool& unsupported) {
+	const uint8_t cmd[2] = { 0x84, 0xB8 };
 
-	Wire.beginTransmission(SI7021_ADDRESS);
-	Wire.write(0x84);
-	Wire.write(0xB8);
-	Wire.endTransmission();
+	_firmwareVersion = 0x00;
 
 	//1 byte only: no checksum
-	Wire.requestFrom(SI7021_ADDRESS, 1);
-	while (Wire.available()) {
-		buffer = Wire.read();
+	uint8_t error = 0;
+	Status status = this->transfer(cmd, 2, &_firmwareVersion, 1, &error);
+	//3: NACK on data
+	unsupported = error == 3;
+	return status;
+}
+
+/// <summary>
+///		Get the 64 bit serial number of the Si7021 sensor. Read once by begin(): no bus traffic.
+///		Building a 64 bit value is expensive on 8 bit MCUs, prefer getShortId() or the 32 bit halves to tag data.
+/// </summary>
+/// <returns>Serial number, 0 if it could not be read or the checksum did not match</returns>
+uint64_t Si7021::getSerialNumber(){
+	this->readIdentity();
+	return ((uint64_t)_serialA << 32) | _serialB;
+}
+
+/// <summary>
+///		Get the upper 32 bits of the serial number (SNA_3 to SNA_0). Read once by begin(): no bus traffic.
+/// </summary>
+/// <returns>Upper half of the serial number, 0 if it could not be read</returns>
+uint32_t Si7021::getSerialNumberHigh(){
+	this->readIdentity();
+	return _serialA;
+}
+
+/// <summary>
+///		Get the lower 32 bits of the serial number (SNB_3 to SNB_0). SNB_3 is the device ID: 0x15 for a Si7021.
+///		Read once by begin(): no bus traffic.
+/// </summary>
+/// <returns>Lower half of the serial number, 0 if it could not be read</returns>
+uint32_t Si7021::getSerialNumberLow(){
+	this->readIdentity();
+	return _serialB;
+}
+
+/// <summary>
+///		Get a 32 bit identifier of the sensor, hashed from its serial number (FNV-1a), to tag data cheaply.
+///		No bus traffic.
+/// </summary>
+/// <returns>Short identifier, 0 if the serial number could not be read</returns>
+uint32_t Si7021::getShortId(){
+	this->readIdentity();
+	if(_serialA == 0 && _serialB == 0){
+		return 0;
 	}
 
-	return buffer;
+	uint32_t hash = 2166136261UL;
+	for(int8_t shift = 24; shift >= 0; shift -= 8){
+		hash = (hash ^ (uint8_t)(_serialA >> shift)) * 16777619UL;
+	}
+	for(int8_t shift = 24; shift >= 0; shift -= 8){
+		hash = (hash ^ (uint8_t)(_serialB >> shift)) * 16777619UL;
+	}
+	return hash;
+}
+
+/// <summary>
+///		Get the firmware revision. 0xFF = Firmware version 1.0 0x20 = Firmware version 2.0
+///		Read once by begin(): no bus traffic.
+///	</summary>
+/// <returns>Firmware version, 0x00 on error</returns>
+uint8_t Si7021::getFirmwareVersion() {
+	this->readIdentity();
+	return _firmwareVersion;
 }
 
 /// <summary>
 ///		Turn on/off the heater.
 /// <param name="on">Set to TRUE for on, FALSE for off</param>
-/// <param name="power">Value between 0 and 15. Strength of the heater. WARNING: power value of 15 uses up to 95mA at 3.3V. Consult the documentation</param>
+/// <param name="power">Value between 0 and 15. Strength of the heater. WARNING: power value of 15 uses up to 95mA at 3.3V. Consult the documentation. Ignored by the fixed strength heater of VARIANT_SHT2X</param>
 ///	</summary>
-void Si7021::setHeater(bool on, uint8_t power)
+/// <returns>FALSE if the sensor did not answer, see getStatus()</returns>
+bool Si7021::setHeater(bool on, uint8_t power)
 {
-	uint8_t reg = 0x00;
-
-	if (on) {
+	//HTU21D/SHT21 heaters have a fixed strength
+	if (on && (this->getCapabilities() & SI7021_CAPABILITY_HEATER_LEVEL)) {
 
 		//filter user input and write heat control (from 0x00 to 0x0F)
-		reg = this->readRegister(SI7021_READ_HEATER_CONTROL_REGISTER);
-		reg |= (power & 0x0F);
-		this->writeRegister(SI7021_WRITE_HEATER_CONTROL_REGISTER, reg);
+		if (this->updateRegister(SI7021_WRITE_HEATER_CONTROL_REGISTER, _heaterRegister, (_heaterRegister & 0xF0) | (power & 0x0F)) != STATUS_OK) {
+			return false;
+		}
 
-		//turn on heater by turning on bit HTRE which is the 3rd bit hence the 0x04 (0b100) mask 
-		reg = 0x3A; //0011 1010 is the default value of this register.
-		reg = this->readRegister(SI7021_READ_USER_REGISTER);
-		reg |= 0x04;
-		this->writeRegister(SI7021_WRITE_USER_REGISTER, reg);
+	}
 
+	if (on) {
+		//turn on heater by turning on bit HTRE which is the 3rd bit hence the 0x04 (0b100) mask 
+		return this->updateRegister(SI7021_WRITE_USER_REGISTER, _userRegister, _userRegister | 0x04) == STATUS_OK;
 	}
 	else {
 		//turn off heater by turning off bit HTRE which is the 3rd bit hence the 0xFB (1111 1011) mask
-		reg = this->readRegister(SI7021_READ_USER_REGISTER);
-		reg &= 0xFB;
-		this->writeRegister(SI7021_WRITE_USER_REGISTER, reg);
+		return this->updateRegister(SI7021_WRITE_USER_REGISTER, _userRegister, _userRegister & 0xFB) == STATUS_OK;
 	}
 }
 
 
-uint8_t Si7021::readRegister(uint8_t registerAddress)
+/// <summary>Read a one byte register</summary>
+/// <param name="registerAddress">Read instruction of the register</param>
+/// <param name="value">Value of the register, left untouched on error</param>
+/// <returns>Status of the read</returns>
+Si7021::Status Si7021::readRegister(uint8_t registerAddress, uint8_t& value)
 {
-	uint8_t buffer;
-
-	Wire.beginTransmission(SI7021_ADDRESS);
-	Wire.write(registerAddress);
-	Wire.endTransmission();
-
 	//1 byte only: no checksum
-	Wire.requestFrom(SI7021_ADDRESS, 1);
-	while (Wire.available()) {
-		buffer = Wire.read();
+	uint8_t data;
+	if (this->transfer(&registerAddress, 1, &data, 1) == STATUS_OK) {
+		value = data;
 	}
-	return buffer;
+	return _status;
 }
 
-void Si7021::writeRegister(uint8_t registerAddress, uint8_t value) {
-	Wire.beginTransmission(SI7021_ADDRESS);
-	Wire.write(registerAddress);
-	Wire.write(value);
-	Wire.endTransmission();
+/// <summary>Write a one byte register</summary>
+/// <param name="registerAddress">Write instruction of the register</param>
+/// <param name="value">New value of the register</param>
+/// <returns>Status of the write</returns>
+Si7021::Status Si7021::writeRegister(uint8_t registerAddress, uint8_t value) {
+	const uint8_t cmd[2] = { registerAddress, value };
+	return this->sendCommand(cmd, 2);
 }
 
+/// <summary>
+///		Write a register through its shadow copy. Nothing goes on the bus if the value is unchanged.
+/// </summary>
+/// <param name="registerAddress">Write instruction of the register</param>
+/// <param name="shadow">Shadow copy of the register, updated on successful write</param>
+/// <param name="value">New value of the register</param>
+/// <returns>Status of the write</returns>
+Si7021::Status Si7021::updateRegister(uint8_t registerAddress, uint8_t& shadow, uint8_t value) {
+	if (value == shadow) {
+		return _status = STATUS_OK;
+	}
+	if (this->writeRegister(registerAddress, value) == STATUS_OK) {
+		shadow = value;
+	}
+	return _status;
+}
 
 /// <summary>
 ///		Set the resolution of sensor.
 /// </summary>
 /// <param name="resolution">Resolution can be: 0 (12 bit RH, 14 bit Temperature), 1 (8 bit RH, 12 Bit Temperature), 2 (10 bit RH, 13 bit Temperature) or 3 (11 bit RH, 11 bit Temperature)</param>
-void Si7021::setSensorResolution(uint8_t resolution) {
+/// <returns>FALSE if the sensor did not answer, see getStatus()</returns>
+bool Si7021::setSensorResolution(uint8_t resolution) {
 	//D7; D0 RES[1:0] Measurement Resolution
 	//D7;D0 :	RH		Temp 
 	// 00	:	12 bit	14 bit 
@@ -260,11 +1501,8 @@ void Si7021::setSensorResolution(uint8_t resolution) {
 	//Why they chose to have the MSB and LSB of user register, making it awkward
 	//to set this resolution? We may never know.
 
-	uint8_t reg = 0x3A; //0011 1010 is the default value of this register
-	reg = this->readRegister(SI7021_READ_USER_REGISTER);
-	
 	//zero off D7 and D0 of the register
-	reg &= 0x7E;
+	uint8_t reg = _userRegister & 0x7E;
 
 	//apply resolution
 	switch (resolution) {
@@ -276,11 +1514,18 @@ void Si7021::setSensorResolution(uint8_t resolution) {
 			break;
 		case 0x03:
 			reg |= 0x81;
+			break;
 		default:
 			break;
 	}
 
-	this->writeRegister(SI7021_WRITE_USER_REGISTER, reg);
-
+	return this->updateRegister(SI7021_WRITE_USER_REGISTER, _userRegister, reg) == STATUS_OK;
+}
 
-}
\ No newline at end of file
+/// <summary>
+///		Get the resolution of the sensor, from the shadow copy of the user register.
+/// </summary>
+/// <returns>Resolution, see setSensorResolution</returns>
+uint8_t Si7021::getSensorResolution() {
+	return ((_userRegister >> 6) & 0x02) | (_userRegister & 0x01);
+}
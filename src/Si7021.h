@@ -11,6 +11,12 @@
   
 */
 
+#ifndef SI7021_H
+#define SI7021_H
+
+#include <stdint.h>
+#include <Wire.h>
+#include "Si7021Bus.h"
 
 //these values are coming directly from the documentation
 //The timeout is set to 
@@ -30,29 +36,304 @@
 //eg: 100 bit per ms, 12.5 byte per ms, 37.5ms to transfer 3 bytes
 #define SI7021_READ_TIMEOUT (uint8_t)50
 
+//build options: SI7021_HAS_CLOCK_STRETCHING, SI7021_CRC_MODE and SI7021_STATS. They change how the library itself is
+//compiled, so set them for the whole build. A #define in the sketch only reaches the sketch, not the library's .cpp files:
+//SI7021_STATS then gives the sketch and the library different class layouts, and the others are ignored.
+//PlatformIO: build_flags = -DSI7021_STATS=1 in platformio.ini
+//Arduino IDE: compiler.cpp.extra_flags=-DSI7021_STATS=1 in a platform.local.txt next to the board's platform.txt
+//Host build: make OPTIONS="-DSI7021_STATS=1", see extras/host/Makefile
+
+//hold master mode keeps SCL low for the whole conversion (up to 23ms). Only use it where the I2C peripheral
+//waits that long on a stretched clock. ESP8266 (230us stretch limit by default) and ESP32 (hardware timeout) don't.
+//Build option: define it to 1 or 0 to override
+#ifndef SI7021_HAS_CLOCK_STRETCHING
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR) || defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_RP2040)
+#define SI7021_HAS_CLOCK_STRETCHING 1
+#else
+#define SI7021_HAS_CLOCK_STRETCHING 0
+#endif
+#endif
+
+//maximum conversion times from the datasheet, in microseconds
+#define SI7021_HUMIDITY_CONVERSION_TIME_12BIT 12000
+#define SI7021_HUMIDITY_CONVERSION_TIME_11BIT 7000
+#define SI7021_HUMIDITY_CONVERSION_TIME_10BIT 4500
+#define SI7021_HUMIDITY_CONVERSION_TIME_8BIT 3100
+#define SI7021_TEMPERATURE_CONVERSION_TIME_14BIT 10800
+#define SI7021_TEMPERATURE_CONVERSION_TIME_13BIT 6200
+#define SI7021_TEMPERATURE_CONVERSION_TIME_12BIT 3800
+#define SI7021_TEMPERATURE_CONVERSION_TIME_11BIT 2400
+
+//default time between two read attempts while the sensor NACKs, in microseconds
+//each attempt costs an address byte on the bus: ~100us at 100 Khz
+#define SI7021_POLL_INTERVAL (uint16_t)500
+
+//consecutive failures after which a sensor is demoted until it succeeds again: Si7021Retry stops retrying it,
+//Si7021Continuous samples it less often
+#define SI7021_FAILURE_STREAK_LIMIT 8
+
+//maximum time the sensor takes to come back after a soft reset, in microseconds (5ms typical)
+#define SI7021_RESET_TIME 15000UL
+
+//default value of the registers after power up or reset
+//user register: 12 bit RH, 14 bit temperature, heater off. Heater control register: lowest heater current
+#define SI7021_USER_REGISTER_DEFAULT 0x3A
+#define SI7021_HEATER_CONTROL_REGISTER_DEFAULT 0x00
+
+//codes returned by the sensor always have their 2 least significant bits cleared
+//so these values can never be a valid reading
+#define SI7021_ERROR_TIMEOUT (uint16_t)1
+#define SI7021_ERROR_CRC (uint16_t)2
+#define SI7021_ERROR_NACK (uint16_t)3
+#define SI7021_IS_ERROR(code) (((code) & 0x03) != 0)
+
+//sizes of the raw codes, to set deadbands in counts: 1% RH is 524 counts, 1 degree Celcius is 373 counts
+#define SI7021_HUMIDITY_COUNTS_PER_PERCENT 524
+#define SI7021_TEMPERATURE_COUNTS_PER_DEGREE 373
+
+//error values of the integer API: out of the range of any valid reading
+#define SI7021_TEMPERATURE_CENTI_ERROR INT16_MIN
+#define SI7021_HUMIDITY_CENTI_ERROR (uint16_t)0xFFFF
+
+//checksum verification of the data read from the sensor. CRC-8, polynomial 0x31 (x^8 + x^5 + x^4 + 1), initialized to 0x00
+//SI7021_CRC_NONE: checksums are ignored
+//SI7021_CRC_BITWISE: computed bit by bit, smallest flash footprint
+//SI7021_CRC_TABLE: 256 bytes lookup table in PROGMEM, fastest
+//Build option, SI7021_CRC_BITWISE by default
+#define SI7021_CRC_NONE 0
+#define SI7021_CRC_BITWISE 1
+#define SI7021_CRC_TABLE 2
+#ifndef SI7021_CRC_MODE
+#define SI7021_CRC_MODE SI7021_CRC_BITWISE
+#endif
+
+//per instance bus and timing counters, see getStats(). 40 bytes of RAM per sensor and a few cycles per transaction
+//Build option: define it to 1 to enable
+#ifndef SI7021_STATS
+#define SI7021_STATS 0
+#endif
+
 //Read Electronic ID 1st Byte 0xFA 0x0F 
 //Read Electronic ID 2nd Byte 0xFC 0xC9 
 //Read Firmware Revision 0x84 0xB8
 
 
+//called before each bus transaction so the sensor's I2C multiplexer channel (or bus) can be selected
+typedef void (*Si7021SelectCallback)(uint8_t channel, void* context);
+
+//called around each bus transaction, eg: to take and give a mutex shared with other devices on the bus
+typedef void (*Si7021LockCallback)(void* context);
+
+class Si7021;
+
+//called by poll() when a measurement started with requestHumidity/requestTemperature completes, successfully or not
+typedef void (*Si7021CompletionCallback)(Si7021& sensor, void* context);
+
 
 class Si7021
 {
+	public:
+		//state of the split-phase (non-blocking) measurement
+		enum State : uint8_t {
+			STATE_IDLE,			//no measurement in progress
+			STATE_CONVERTING,	//command issued, waiting for the sensor to finish
+			STATE_READY,		//result available through getResult()
+			STATE_TIMEOUT,		//sensor never answered
+			STATE_CRC_ERROR		//result was corrupted on the bus
+		};
+
+		//outcome of the last operation, see getStatus()
+		enum Status : uint8_t {
+			STATUS_OK,
+			STATUS_NACK,		//sensor did not acknowledge a command byte, or bus error
+			STATUS_TIMEOUT,		//conversion result never came
+			STATUS_CRC_ERROR,	//data was corrupted on the bus
+			STATUS_NOT_PRESENT,	//sensor did not acknowledge its address. Calls fail without bus traffic until probe(), begin() or reset()
+			STATUS_BUSY			//a non-blocking measurement is already in progress
+		};
+
+		//how the end of a conversion is detected, see setReadyMode()
+		enum ReadyMode : uint8_t {
+			READY_TIMED,		//wait for the worst case conversion time of the current resolution, then read
+			READY_NACK_POLLING,	//try to read every poll interval: the sensor NACKs until the conversion is done
+			READY_HOLD_MASTER	//read right away, the sensor stretches the clock until the conversion is done. Blocks inside poll()
+		};
+
+		//part found by begin(), from its firmware revision and electronic ID. Picks the conversion times and the commands used
+		enum Variant : uint8_t {
+			VARIANT_UNKNOWN,	//not identified yet: handled as a Si7021
+			VARIANT_SI7013,
+			VARIANT_SI7020,
+			VARIANT_SI7021,
+			VARIANT_SI70XX,		//other member of the family, or engineering sample: handled as a Si7021
+			VARIANT_SHT2X		//HTU21D, SHT21 and compatibles: no firmware revision, no temperature read back, slower conversions
+		};
+
+		//bus and timing counters, see getStats(). Times are in microseconds
+		struct Stats {
+			uint32_t transactions;		//writes and reads on the bus, NACKed ones included
+			uint32_t bytes;				//bytes moved on the bus, address bytes included
+			uint32_t waitTime;			//time the blocking API spent waiting for conversions, busy or asleep
+			uint32_t measurements;		//conversions that returned a valid result
+			uint16_t timeouts;
+			uint16_t crcErrors;
+			uint32_t pollAttempts;		//read attempts NACKed because the conversion was not done yet, see setReadyMode()
+			uint32_t minLatency;		//from the command to the result of a conversion
+			uint32_t maxLatency;
+			uint32_t totalLatency;
+			uint32_t getAverageLatency() const { return measurements ? totalLatency / measurements : 0; }
+		};
+
+		//configuration applied by begin(config)
+		struct Config {
+			uint8_t resolution;		//see setSensorResolution()
+			bool heater;
+			uint8_t heaterPower;	//see setHeater()
+			Config(uint8_t resolution = 0, bool heater = false, uint8_t heaterPower = 0x00) : resolution(resolution), heater(heater), heaterPower(heaterPower) {};
+		};
+
+		//a humidity measurement and the temperature converted along with it, kept as raw codes
+		struct Reading {
+			uint16_t humidityCode;
+			uint16_t temperatureCode;
+			uint32_t timestamp;		//millis() when the reading was taken
+			float getHumidity() const { return Si7021::convertHumidity(humidityCode); }
+			float getTemperature() const { return Si7021::convertTemperature(temperatureCode); }
+			float getTemperatureF() const { return Si7021::convertTemperatureF(temperatureCode); }
+			float getTemperatureK() const { return Si7021::convertTemperatureK(temperatureCode); }
+			uint16_t getHumidityCenti() const { return Si7021::convertHumidityCenti(humidityCode); }
+			int16_t getTemperatureCenti() const { return Si7021::convertTemperatureCenti(temperatureCode); }
+		};
+	//broadcasts measurement instructions through a multiplexer on behalf of its sensors
+	friend class Si7021Array;
 	private:
-		uint16_t readSensor(const uint8_t instr, const int8_t returnSize);
-		uint8_t readRegister(uint8_t registerAddress);
-		void writeRegister(uint8_t registerAddress, uint8_t value);
+		Si7021WireBus _wireBus;
+		Si7021Bus* _bus;
+		uint8_t _address;
+		Si7021SelectCallback _select;
+		void* _selectContext;
+		uint8_t _channel;
+		Si7021LockCallback _lock;
+		Si7021LockCallback _unlock;
+		void* _lockContext;
+		Si7021CompletionCallback _completion;
+		void* _completionContext;
+		State _state;
+		Status _status;
+		bool _present;
+		uint8_t _command;
+		int8_t _returnSize;
+		uint32_t _startTime;
+		uint32_t _nextAttempt;
+		ReadyMode _readyMode;
+		uint16_t _pollInterval;
+		uint16_t _result;
+		bool _readBack;
+		bool _discard;
+		uint16_t _readBackTemperature;
+		uint32_t _conversionTime;
+		uint8_t _userRegister;
+		uint8_t _heaterRegister;
+		uint32_t _serialA;
+		uint32_t _serialB;
+		uint8_t _firmwareVersion;
+		bool _identityRead;
+		Variant _variant;
+#if SI7021_STATS
+		Stats _stats;
+#endif
+		Si7021Bus& bus();
+		bool waitReady(uint32_t timeout);
+		void select();
+		Status sendCommand(const uint8_t* bytes, uint8_t length);
+		Status writeStatus(uint8_t error);
+		uint8_t readBytes(uint8_t* buffer, const int8_t quantity);
+		Status transfer(const uint8_t* bytes, uint8_t length, uint8_t* buffer, const int8_t quantity, uint8_t* busError = NULL);
+		Status exchange(const uint8_t* bytes, uint8_t length, uint8_t* buffer, const int8_t quantity, uint8_t* busError = NULL);
+		uint8_t getCapabilities();
+		uint32_t getConversionTime(const uint8_t instr);
+		Status startMeasurement(const uint8_t instr, const int8_t returnSize, bool readBack = false);
+		void arm(const uint8_t instr, const int8_t returnSize, bool hold, bool readBack = false);
+		static State decodeFrame(const uint8_t* frame, const int8_t returnSize, uint16_t& value);
+		State update();
+		void pause(uint32_t us);
+		Status convert(const uint8_t instr, const int8_t returnSize, uint16_t& value, uint16_t* temperature = NULL);
+		Status readSensor(const uint8_t instr, const int8_t returnSize, uint16_t& value, uint16_t* temperature = NULL);
+		Status readImmediate(const uint8_t instr, const int8_t returnSize, uint16_t& value);
+		Status readRegister(uint8_t registerAddress, uint8_t& value);
+		Status writeRegister(uint8_t registerAddress, uint8_t value);
+		Status updateRegister(uint8_t registerAddress, uint8_t& shadow, uint8_t value);
+		static uint16_t toCode(Status status, uint16_t value);
+		Status readSerialNumber();
+		Status readFirmwareVersion(bool& unsupported);
+		bool connect(bool identify);
+		void readIdentity();
 	public:
-		Si7021();
-		void begin();
+		Si7021(TwoWire& wire = Wire, uint8_t address = SI7021_ADDRESS);
+		Si7021(Si7021Bus& bus, uint8_t address = SI7021_ADDRESS);
+		bool begin();
+		bool begin(const Config& config);
+		Status probe();
+		bool isPresent();
+		Status getStatus();
+		Status measure(Reading& reading);
+		void setMuxChannel(Si7021SelectCallback select, uint8_t channel, void* context = NULL);
+		void setBusLock(Si7021LockCallback lock, Si7021LockCallback unlock, void* context = NULL);
 		void reset();
 		float measureTemperature();
 		float getTemperatureFromPreviousHumidityMeasurement();
 		float measureHumidity();
+		bool measureHumidityAndTemperature(float& humidity, float& temperature);
 		float measureTemperatureF();
 		float getTemperatureFromPreviousHumidityMeasurementF();
+		float measureTemperatureK();
+		float getTemperatureFromPreviousHumidityMeasurementK();
 		uint64_t getSerialNumber();
+		uint32_t getSerialNumberHigh();
+		uint32_t getSerialNumberLow();
+		uint32_t getShortId();
 		uint8_t getFirmwareVersion();
-		void setHeater(bool on, uint8_t power = 0x00);
-		void setSensorResolution(uint8_t resolution);
+		Variant getVariant();
+		bool canReadBack();
+		bool setHeater(bool on, uint8_t power = 0x00);
+		bool setSensorResolution(uint8_t resolution);
+		uint8_t getSensorResolution();
+		bool setReadyMode(ReadyMode mode, uint16_t pollInterval = SI7021_POLL_INTERVAL);
+#if SI7021_STATS
+		const Stats& getStats();
+		void resetStats();
+#endif
+		ReadyMode getReadyMode();
+		bool startHumidityMeasurement(bool readBack = false);
+		bool startTemperatureMeasurement();
+		bool requestHumidity(Si7021CompletionCallback callback, void* context = NULL);
+		bool requestTemperature(Si7021CompletionCallback callback, void* context = NULL);
+		State poll();
+		State getState();
+		uint32_t getMillis();
+		uint32_t getMicros();
+		void wait(uint32_t us);
+		uint32_t getWaitTime();
+		void addElapsedTime(uint32_t us);
+		uint32_t getLastConversionTime();
+		bool isReady();
+		void cancelMeasurement();
+		float getResult();
+		uint16_t getRawResult();
+		uint16_t getReadBackTemperatureRaw();
+		int16_t measureTemperatureCenti();
+		int16_t getTemperatureFromPreviousHumidityMeasurementCenti();
+		uint16_t measureHumidityCenti();
+		uint16_t measureTemperatureRaw();
+		uint16_t getTemperatureFromPreviousHumidityMeasurementRaw();
+		uint16_t measureHumidityRaw();
+		static float convertTemperature(uint16_t code);
+		static float convertTemperatureF(uint16_t code);
+		static float convertTemperatureK(uint16_t code);
+		static float convertHumidity(uint16_t code);
+		static int16_t convertTemperatureCenti(uint16_t code);
+		static uint16_t convertHumidityCenti(uint16_t code);
+		static uint8_t crc8(const uint8_t* data, uint8_t length, uint8_t crc = 0x00);
 };
+
+#endif
@@ -0,0 +1,161 @@
+/*
+  Si7021Array.cpp
+  Drive several Si7021 sensors at once: conversions run in parallel and results
+  are collected as they complete.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Array.h"
+
+/// <summary>Group sensors so they can be measured together</summary>
+/// <param name="sensors">Sensors to drive, usually one per bus or multiplexer channel. The array must outlive this object</param>
+/// <param name="count">Number of sensors, up to SI7021_ARRAY_MAX_SENSORS</param>
+Si7021Array::Si7021Array(Si7021** sensors, uint8_t count) : _sensors(sensors), _count(count), _pending(0), _mux(NULL) {
+	if(_count > SI7021_ARRAY_MAX_SENSORS){
+		_count = SI7021_ARRAY_MAX_SENSORS;
+	}
+};
+
+/// <summary>
+///		Start the conversions of sensors behind a TCA9548A with a single transaction: all their channels are connected
+///		and the instruction is written once, all sensors receiving it at the same time. Results are then collected one
+///		channel after the other, so a round costs one channel switch per sensor plus one, instead of two.
+///		Applies when every sensor was given this multiplexer with setMuxChannel(Si7021Mux::selectChannel, channel, mux),
+///		shares the same address, is idle and is not in READY_HOLD_MASTER mode. Otherwise sensors are started one by one.
+/// </summary>
+/// <param name="mux">Multiplexer the sensors are behind, NULL to always start them one by one</param>
+void Si7021Array::setMux(Si7021Mux* mux){
+	_mux = mux;
+}
+
+/// <summary>Write a measurement instruction to all sensors at once through the multiplexer</summary>
+/// <param name="instr">No hold master mode instruction</param>
+/// <returns>FALSE if the sensors cannot be broadcast to, or nobody answered: start them one by one</returns>
+bool Si7021Array::broadcast(uint8_t instr){
+
+	if(!_mux || _count == 0){
+		return false;
+	}
+
+	Si7021* first = _sensors[0];
+	uint8_t mask = 0;
+	for(uint8_t i = 0; i < _count; i++){
+		Si7021* sensor = _sensors[i];
+		if(sensor->_select != Si7021Mux::selectChannel || sensor->_selectContext != _mux || sensor->_channel >= SI7021_MUX_CHANNELS ||
+				sensor->_address != first->_address || sensor->_readyMode == Si7021::READY_HOLD_MASTER ||
+				sensor->_state == Si7021::STATE_CONVERTING || !sensor->_present){
+			return false;
+		}
+		mask |= (uint8_t)(1 << sensor->_channel);
+	}
+
+	//sensors on one bus share its lock
+	if(first->_lock){
+		first->_lock(first->_lockContext);
+	}
+	bool ok = _mux->broadcast(mask, first->_address, instr);
+	if(first->_unlock){
+		first->_unlock(first->_lockContext);
+	}
+	if(!ok){
+		return false;
+	}
+
+	for(uint8_t i = 0; i < _count; i++){
+		_sensors[i]->arm(instr, 3, false);
+		_pending |= (1UL << i);
+	}
+
+	return true;
+}
+
+/// <summary>Kick off a conversion on every sensor, back to back, without waiting for any of them</summary>
+/// <param name="humidity">TRUE for a humidity measurement, FALSE for temperature only</param>
+/// <returns>Number of sensors that started converting</returns>
+uint8_t Si7021Array::start(bool humidity){
+
+	if(this->broadcast(humidity ? SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE : SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE)){
+		return _count;
+	}
+
+	uint8_t started = 0;
+
+	for(uint8_t i = 0; i < _count; i++){
+		Si7021* sensor = _sensors[i];
+		bool ok = humidity ? sensor->startHumidityMeasurement() : sensor->startTemperatureMeasurement();
+		if(ok){
+			_pending |= (1UL << i);
+			started++;
+		}
+	}
+
+	return started;
+}
+
+/// <summary>
+///		Start a relative humidity measurement on all sensors. N sensors cost about one conversion time instead of N.
+/// 	<seealso cref="Si7021Array::poll"/>  
+/// </summary>
+/// <returns>Number of sensors that started converting</returns>
+uint8_t Si7021Array::startHumidityMeasurement(){
+	return this->start(true);
+}
+
+/// <summary>
+///		Start a temperature measurement on all sensors.
+/// 	<seealso cref="Si7021Array::poll"/>  
+/// </summary>
+/// <returns>Number of sensors that started converting</returns>
+uint8_t Si7021Array::startTemperatureMeasurement(){
+	return this->start(false);
+}
+
+/// <summary>
+///		Advance the measurement of all sensors. Never blocks. Each sensor is reported once, in completion order:
+///		call it until it returns -1, then read the result of the returned sensor with getSensor(index)->getResult()
+///		after checking it with getState(index).
+/// </summary>
+/// <returns>Index of a sensor whose measurement just completed or timed out, -1 if none</returns>
+int8_t Si7021Array::poll(){
+
+	for(uint8_t i = 0; i < _count; i++){
+		if(!(_pending & (1UL << i))){
+			continue;
+		}
+		if(_sensors[i]->poll() != Si7021::STATE_CONVERTING){
+			_pending &= ~(1UL << i);
+			return (int8_t)i;
+		}
+	}
+
+	return -1;
+}
+
+/// <summary>Check if all started measurements have been reported by poll()</summary>
+/// <returns>TRUE if no sensor is left converting</returns>
+bool Si7021Array::isDone(){
+	return _pending == 0;
+}
+
+/// <returns>Number of sensors in the array</returns>
+uint8_t Si7021Array::getCount(){
+	return _count;
+}
+
+/// <param name="index">Index of the sensor</param>
+/// <returns>The sensor, NULL if index is out of range</returns>
+Si7021* Si7021Array::getSensor(uint8_t index){
+	return index < _count ? _sensors[index] : NULL;
+}
+
+/// <summary>Status of a sensor, without advancing its measurement: STATE_READY when its result can be read, STATE_TIMEOUT if it did not answer</summary>
+/// <param name="index">Index of the sensor</param>
+/// <returns>State of the sensor's measurement</returns>
+Si7021::State Si7021Array::getState(uint8_t index){
+	return index < _count ? _sensors[index]->getState() : Si7021::STATE_IDLE;
+}
@@ -0,0 +1,43 @@
+/*
+  Si7021Array.h
+  Drive several Si7021 sensors at once: conversions run in parallel and results
+  are collected as they complete.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_ARRAY_H
+#define SI7021_ARRAY_H
+
+#include <stdint.h>
+#include "Si7021.h"
+#include "Si7021Mux.h"
+
+//sensors waiting for their result are tracked in a 32 bit mask
+#define SI7021_ARRAY_MAX_SENSORS 32
+
+
+class Si7021Array
+{
+	private:
+		Si7021** _sensors;
+		uint8_t _count;
+		uint32_t _pending;
+		Si7021Mux* _mux;
+		uint8_t start(bool humidity);
+		bool broadcast(uint8_t instr);
+	public:
+		Si7021Array(Si7021** sensors, uint8_t count);
+		void setMux(Si7021Mux* mux);
+		uint8_t startHumidityMeasurement();
+		uint8_t startTemperatureMeasurement();
+		int8_t poll();
+		bool isDone();
+		uint8_t getCount();
+		Si7021* getSensor(uint8_t index);
+		Si7021::State getState(uint8_t index);
+};
+
+#endif
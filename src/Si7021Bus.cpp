@@ -0,0 +1,57 @@
+/*
+  Si7021Bus.cpp
+  Bus and time source used by the Si7021 class. Si7021WireBus goes through the
+  Arduino Wire library and clock; Si7021Sim (Si7021Sim.h) models a sensor so the
+  driver can run and be measured without one.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <Wire.h>
+#include "Si7021Bus.h"
+
+Si7021WireBus::Si7021WireBus(TwoWire& wire) : _wire(&wire) {};
+
+/// <summary>Init Arduino I2C lib</summary>
+void Si7021WireBus::begin(){
+	_wire->begin();
+}
+
+uint8_t Si7021WireBus::write(uint8_t address, const uint8_t* bytes, uint8_t length, bool stop){
+	_wire->beginTransmission(address);
+	for(uint8_t i = 0; i < length; i++){
+		_wire->write(bytes[i]);
+	}
+	return _wire->endTransmission(stop);
+}
+
+uint8_t Si7021WireBus::read(uint8_t address, uint8_t* buffer, uint8_t quantity){
+	uint8_t received = _wire->requestFrom(address, quantity);
+	for(uint8_t i = 0; i < received; i++){
+		buffer[i] = _wire->read();
+	}
+	return received;
+}
+
+uint32_t Si7021WireBus::micros(){
+	return ::micros();
+}
+
+uint32_t Si7021WireBus::millis(){
+	return ::millis();
+}
+
+/// <summary>Busy wait</summary>
+/// <param name="us">Time to wait, in microseconds</param>
+void Si7021WireBus::wait(uint32_t us){
+	//delayMicroseconds is only accurate up to 16383us on AVR
+	if(us >= 1000){
+		delay(us / 1000);
+		us %= 1000;
+	}
+	delayMicroseconds(us);
+}
@@ -0,0 +1,60 @@
+/*
+  Si7021Bus.h
+  Bus and time source used by the Si7021 class. Si7021WireBus goes through the
+  Arduino Wire library and clock; Si7021Sim (Si7021Sim.h) models a sensor so the
+  driver can run and be measured without one.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_BUS_H
+#define SI7021_BUS_H
+
+#include <stdint.h>
+#include <Wire.h>
+
+
+class Si7021Bus
+{
+	public:
+		virtual void begin() = 0;
+
+		/// <summary>Write bytes to a device, as one transaction</summary>
+		/// <param name="address">7 bit address of the device</param>
+		/// <param name="bytes">Bytes to write, NULL when length is 0</param>
+		/// <param name="length">Number of bytes. 0 only addresses the device</param>
+		/// <param name="stop">FALSE to keep the bus and follow with a repeated start</param>
+		/// <returns>As Wire.endTransmission(): 0 success, 2 NACK on address, 3 NACK on data, 4 other error</returns>
+		virtual uint8_t write(uint8_t address, const uint8_t* bytes, uint8_t length, bool stop) = 0;
+
+		/// <summary>Read bytes from a device, as one transaction</summary>
+		/// <param name="address">7 bit address of the device</param>
+		/// <param name="buffer">Where to store the bytes</param>
+		/// <param name="quantity">Number of bytes to read</param>
+		/// <returns>Number of bytes received, 0 if the device NACKed its address</returns>
+		virtual uint8_t read(uint8_t address, uint8_t* buffer, uint8_t quantity) = 0;
+
+		//time source of the driver. Wire based buses use the Arduino clock
+		virtual uint32_t micros() = 0;
+		virtual uint32_t millis() = 0;
+		virtual void wait(uint32_t us) = 0;
+};
+
+
+class Si7021WireBus : public Si7021Bus
+{
+	private:
+		TwoWire* _wire;
+	public:
+		Si7021WireBus(TwoWire& wire = Wire);
+		virtual void begin();
+		virtual uint8_t write(uint8_t address, const uint8_t* bytes, uint8_t length, bool stop);
+		virtual uint8_t read(uint8_t address, uint8_t* buffer, uint8_t quantity);
+		virtual uint32_t micros();
+		virtual uint32_t millis();
+		virtual void wait(uint32_t us);
+};
+
+#endif
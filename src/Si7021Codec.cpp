@@ -0,0 +1,143 @@
+/*
+  Si7021Codec.cpp
+  Compact binary records of readings, to send over a serial link or a radio
+  instead of text. No heap, no floats: raw codes are bit-packed with the time
+  since the previous reading.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Codec.h"
+
+/// <summary>Write a 32 bit value, little endian</summary>
+static void writeLong(uint8_t* buffer, uint32_t value){
+	buffer[0] = (uint8_t)value;
+	buffer[1] = (uint8_t)(value >> 8);
+	buffer[2] = (uint8_t)(value >> 16);
+	buffer[3] = (uint8_t)(value >> 24);
+}
+
+/// <summary>Read a 32 bit value, little endian</summary>
+static uint32_t readLong(const uint8_t* buffer){
+	return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+void Si7021Codec::writeHeader(uint8_t* buffer, uint32_t id, uint32_t timestamp, uint8_t count){
+	writeLong(buffer, id);
+	writeLong(buffer + 4, timestamp);
+	buffer[8] = count;
+}
+
+void Si7021Codec::writeReading(uint8_t* buffer, const Si7021::Reading& reading, uint32_t delta){
+	//48 bits as a 32 bit low part and a 16 bit high part: no 64 bit math
+	uint32_t low = (uint32_t)(reading.temperatureCode >> 2) | ((uint32_t)(reading.humidityCode >> 4) << 14) | (delta << 26);
+	uint16_t high = (uint16_t)(delta >> 6);
+	writeLong(buffer, low);
+	buffer[4] = (uint8_t)high;
+	buffer[5] = (uint8_t)(high >> 8);
+}
+
+/// <summary>
+///		Encode readings into a batch. Stops early when the buffer is full or when the time between two readings
+///		exceeds SI7021_CODEC_MAX_DELTA: encode the rest into the next batch.
+/// </summary>
+/// <param name="buffer">Where to write the batch</param>
+/// <param name="size">Size of buffer, SI7021_CODEC_SIZE(count) for all the readings to fit</param>
+/// <param name="id">Identifier of the sensor, eg: getShortId()</param>
+/// <param name="readings">Readings to encode, oldest first</param>
+/// <param name="count">Number of readings</param>
+/// <returns>Size of the batch in bytes, 0 if not even one reading fits. The number of readings encoded is in the header</returns>
+size_t Si7021Codec::encode(uint8_t* buffer, size_t size, uint32_t id, const Si7021::Reading* readings, uint8_t count){
+
+	if(count == 0 || size < SI7021_CODEC_SIZE(1)){
+		return 0;
+	}
+
+	uint8_t encoded = 0;
+	uint32_t previous = readings[0].timestamp;
+	while(encoded < count && SI7021_CODEC_SIZE(encoded + 1) <= size){
+		uint32_t delta = readings[encoded].timestamp - previous;
+		if(delta > SI7021_CODEC_MAX_DELTA){
+			break;
+		}
+		writeReading(buffer + SI7021_CODEC_SIZE(encoded), readings[encoded], delta);
+		previous = readings[encoded].timestamp;
+		encoded++;
+	}
+
+	writeHeader(buffer, id, readings[0].timestamp, encoded);
+	return SI7021_CODEC_SIZE(encoded);
+}
+
+/// <summary>
+///		Encode readings straight out of a continuous sampling buffer, oldest first, into a batch. The readings encoded
+///		are removed from the buffer, the others stay for the next batch.
+/// </summary>
+/// <param name="buffer">Where to write the batch</param>
+/// <param name="size">Size of buffer</param>
+/// <param name="samples">Continuous sampling of a sensor. The sensor's getShortId() identifies the batch</param>
+/// <returns>Size of the batch in bytes, 0 if there was nothing to encode or buffer is too small</returns>
+size_t Si7021Codec::encode(uint8_t* buffer, size_t size, Si7021Continuous& samples){
+
+	Si7021::Reading reading;
+	if(size < SI7021_CODEC_SIZE(1) || !samples.peek(reading)){
+		return 0;
+	}
+
+	uint32_t first = reading.timestamp;
+	uint32_t previous = first;
+	uint8_t encoded = 0;
+	while(encoded < SI7021_CODEC_MAX_READINGS && SI7021_CODEC_SIZE(encoded + 1) <= size && samples.peek(reading)){
+		uint32_t delta = reading.timestamp - previous;
+		if(delta > SI7021_CODEC_MAX_DELTA){
+			break;
+		}
+		writeReading(buffer + SI7021_CODEC_SIZE(encoded), reading, delta);
+		samples.drain(&reading, 1);
+		previous = reading.timestamp;
+		encoded++;
+	}
+
+	writeHeader(buffer, samples.getSensor().getShortId(), first, encoded);
+	return SI7021_CODEC_SIZE(encoded);
+}
+
+/// <summary>Decode a batch back into readings</summary>
+/// <param name="buffer">The batch</param>
+/// <param name="length">Size of the batch in bytes</param>
+/// <param name="id">Identifier of the sensor</param>
+/// <param name="readings">Where to store the readings. Codes have the resolution of the batch: 14 bit temperature, 12 bit humidity</param>
+/// <param name="max">Maximum number of readings to store</param>
+/// <returns>Number of readings decoded, 0 if the batch is truncated</returns>
+uint8_t Si7021Codec::decode(const uint8_t* buffer, size_t length, uint32_t& id, Si7021::Reading* readings, uint8_t max){
+
+	if(length < SI7021_CODEC_HEADER_SIZE){
+		return 0;
+	}
+
+	id = readLong(buffer);
+	uint32_t timestamp = readLong(buffer + 4);
+	uint8_t count = buffer[8];
+	if(length < SI7021_CODEC_SIZE(count)){
+		return 0;
+	}
+	if(count > max){
+		count = max;
+	}
+
+	for(uint8_t i = 0; i < count; i++){
+		const uint8_t* record = buffer + SI7021_CODEC_SIZE(i);
+		uint32_t low = readLong(record);
+		uint32_t delta = (low >> 26) | ((uint32_t)record[4] << 6) | ((uint32_t)record[5] << 14);
+		timestamp += delta;
+		readings[i].temperatureCode = (uint16_t)(low << 2) & 0xFFFC;
+		readings[i].humidityCode = (uint16_t)((low >> 14) << 4) & 0xFFF0;
+		readings[i].timestamp = timestamp;
+	}
+
+	return count;
+}
@@ -0,0 +1,45 @@
+/*
+  Si7021Codec.h
+  Compact binary records of readings, to send over a serial link or a radio
+  instead of text. No heap, no floats: raw codes are bit-packed with the time
+  since the previous reading.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_CODEC_H
+#define SI7021_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Si7021.h"
+#include "Si7021Continuous.h"
+
+//a batch is little endian:
+//header: short ID of the sensor (4 bytes), timestamp of the first reading in ms (4 bytes), number of readings (1 byte)
+//each reading: 48 bits, temperature code >> 2 (14 bits), humidity code >> 4 (12 bits), ms since the previous reading (22 bits)
+#define SI7021_CODEC_HEADER_SIZE 9
+#define SI7021_CODEC_READING_SIZE 6
+#define SI7021_CODEC_SIZE(readings) ((size_t)SI7021_CODEC_HEADER_SIZE + (size_t)(readings) * SI7021_CODEC_READING_SIZE)
+
+//longest time between two readings of a batch, in ms: about 70 minutes. A longer gap starts a new batch
+#define SI7021_CODEC_MAX_DELTA 0x3FFFFFUL
+
+//readings in a batch, counted on 1 byte
+#define SI7021_CODEC_MAX_READINGS 255
+
+
+class Si7021Codec
+{
+	private:
+		static void writeHeader(uint8_t* buffer, uint32_t id, uint32_t timestamp, uint8_t count);
+		static void writeReading(uint8_t* buffer, const Si7021::Reading& reading, uint32_t delta);
+	public:
+		static size_t encode(uint8_t* buffer, size_t size, uint32_t id, const Si7021::Reading* readings, uint8_t count);
+		static size_t encode(uint8_t* buffer, size_t size, Si7021Continuous& samples);
+		static uint8_t decode(const uint8_t* buffer, size_t length, uint32_t& id, Si7021::Reading* readings, uint8_t max);
+};
+
+#endif
@@ -0,0 +1,298 @@
+/*
+  Si7021Continuous.cpp
+  Sample humidity and temperature at a fixed rate in the background, into a
+  ring buffer of raw readings (8 bytes each). Runs on the non-blocking API of
+  the sensor: only the sensors sampled that way pay for the buffer and its
+  bookkeeping.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Continuous.h"
+
+/// <summary>Continuous sampling of a sensor. Nothing is sampled until start()</summary>
+/// <param name="sensor">Sensor to sample, already started with begin()</param>
+Si7021Continuous::Si7021Continuous(Si7021& sensor) :
+	_sensor(&sensor), _ring(NULL), _capacity(0), _head(0), _count(0), _droppedCount(0), _interval(0), _nextSample(0),
+	_sampling(false), _temperatureStep(false), _sampleHumidity(0), _failureStreak(0),
+	_filter(NULL), _heater(NULL) {};
+
+/// <summary>
+///		Start sampling. poll() starts the conversions and stores the results in buffer as raw codes; get them with
+///		drain(). When the buffer is full the oldest reading is dropped. Measurements of the application, blocking or
+///		not, can still be made in between: a sample waits for them.
+/// </summary>
+/// <param name="buffer">Storage for the readings, usually a static array. Must outlive the sampling</param>
+/// <param name="capacity">Number of readings buffer can hold</param>
+/// <param name="interval">Time between two samples, in milliseconds</param>
+/// <returns>FALSE if buffer is NULL or capacity is 0</returns>
+bool Si7021Continuous::start(Si7021::Reading* buffer, size_t capacity, uint32_t interval){
+
+	if(buffer == NULL || capacity == 0){
+		return false;
+	}
+
+	this->stop();
+	_ring = buffer;
+	_capacity = capacity;
+	_head = 0;
+	_count = 0;
+	_droppedCount = 0;
+	_failureStreak = 0;
+	_interval = interval;
+	_nextSample = _sensor->getMillis();
+	return true;
+}
+
+/// <summary>
+///		Stop sampling. Readings still in the buffer are lost: drain() them first.
+/// </summary>
+void Si7021Continuous::stop(){
+	//a conversion of ours still in progress runs to its end, its result is dropped
+	if(_sampling){
+		_sensor->cancelMeasurement();
+		_sampling = false;
+	}
+	_ring = NULL;
+	_count = 0;
+}
+
+/// <returns>TRUE if sampling is running</returns>
+bool Si7021Continuous::isRunning(){
+	return _ring != NULL;
+}
+
+/// <summary>
+///		Advance the sensor's measurement (see Si7021::poll()), store the sample it just finished and start the next
+///		one when due. Never blocks: call it from your main loop, instead of the sensor's poll().
+/// </summary>
+/// <returns>State of the sensor's measurement</returns>
+Si7021::State Si7021Continuous::poll(){
+
+	Si7021::State state = _sensor->poll();
+	if(!_ring){
+		return state;
+	}
+
+	if(_sampling){
+		if(state == Si7021::STATE_CONVERTING){
+			return state;
+		}
+		this->complete();
+		if(_sampling){
+			return _sensor->getState();
+		}
+	}
+
+	//between two conversions: the heater is switched by register writes
+	if(_heater){
+		_heater->poll();
+	}
+
+	//don't step on a non-blocking measurement of the application
+	state = _sensor->getState();
+	if(state == Si7021::STATE_CONVERTING || state == Si7021::STATE_READY){
+		return state;
+	}
+
+	uint32_t now = _sensor->getMillis();
+	if((int32_t)(now - _nextSample) < 0){
+		return state;
+	}
+
+	//keep a fixed rate, unless we are more than a full interval late. A failing sensor is sampled less often
+	uint32_t interval = this->isDemoted() ? _interval * SI7021_DEMOTED_INTERVAL_FACTOR : _interval;
+	_nextSample += interval;
+	if((int32_t)(now - _nextSample) >= 0){
+		_nextSample = now + interval;
+	}
+
+	//a sensor reported missing fails every call without bus traffic: ask it again, a single address byte
+	if(!_sensor->isPresent() && _sensor->probe() != Si7021::STATUS_OK){
+		this->track(false);
+		return _sensor->getState();
+	}
+
+	_sampling = _sensor->startHumidityMeasurement(true);
+	_temperatureStep = false;
+	if(!_sampling){
+		this->track(false);
+	}
+	return _sensor->getState();
+}
+
+/// <summary>
+///		Store the sample whose conversion just ended. On a part without temperature read back the humidity is kept and
+///		the temperature conversion started: the sample stays in progress
+/// </summary>
+void Si7021Continuous::complete(){
+
+	_sampling = false;
+	if(_sensor->getState() != Si7021::STATE_READY){
+		//timed out or corrupted: the next sample is started from there
+		this->track(false);
+		return;
+	}
+
+	uint16_t code = _sensor->getRawResult();
+	Si7021::Reading reading;
+	if(_temperatureStep){
+		//second step on a part without temperature read back
+		reading.humidityCode = _sampleHumidity;
+		reading.temperatureCode = code;
+	}
+	else if(_sensor->canReadBack()){
+		reading.humidityCode = code;
+		reading.temperatureCode = _sensor->getReadBackTemperatureRaw();
+		if(SI7021_IS_ERROR(reading.temperatureCode)){
+			//the read back failed: the temperature is still latched in the sensor
+			reading.temperatureCode = _sensor->getTemperatureFromPreviousHumidityMeasurementRaw();
+			if(SI7021_IS_ERROR(reading.temperatureCode)){
+				this->track(false);
+				return;
+			}
+		}
+	}
+	else{
+		//the temperature takes its own conversion, the sample stays in progress
+		_sampleHumidity = code;
+		_sampling = _sensor->startTemperatureMeasurement();
+		_temperatureStep = true;
+		if(!_sampling){
+			this->track(false);
+		}
+		return;
+	}
+
+	reading.timestamp = _sensor->getMillis();
+	this->track(true);
+
+	//a heater biased sample is dropped right away
+	if(_heater && !_heater->add(reading)){
+		return;
+	}
+	this->push(reading);
+}
+
+/// <summary>Store a reading in the buffer, dropping the oldest one if full</summary>
+/// <param name="reading">Reading to store</param>
+void Si7021Continuous::push(const Si7021::Reading& reading){
+
+	if(_filter && !_filter->add(reading)){
+		return;
+	}
+
+	_ring[_head] = reading;
+	if(++_head >= _capacity){
+		_head = 0;
+	}
+
+	if(_count < _capacity){
+		_count++;
+	}
+	else{
+		_droppedCount++;
+	}
+}
+
+/// <summary>Keep track of consecutive failed samples</summary>
+/// <param name="success">TRUE for a sample stored, FALSE for a step of a sample that failed</param>
+void Si7021Continuous::track(bool success){
+	if(success){
+		_failureStreak = 0;
+	}
+	else if(_failureStreak < 0xFF){
+		_failureStreak++;
+	}
+}
+
+/// <returns>Number of readings waiting in the buffer</returns>
+size_t Si7021Continuous::available(){
+	return _count;
+}
+
+/// <summary>
+///		Move readings out of the buffer, oldest first.
+/// </summary>
+/// <param name="out">Where to copy the readings</param>
+/// <param name="max">Maximum number of readings to copy</param>
+/// <returns>Number of readings copied</returns>
+size_t Si7021Continuous::drain(Si7021::Reading* out, size_t max){
+
+	size_t count = 0;
+
+	while(count < max && _count > 0){
+		size_t tail = _head + _capacity - _count;
+		if(tail >= _capacity){
+			tail -= _capacity;
+		}
+		out[count++] = _ring[tail];
+		_count--;
+	}
+
+	return count;
+}
+
+/// <summary>
+///		Copy the oldest reading of the buffer without removing it, eg: to check it fits somewhere first.
+/// </summary>
+/// <param name="out">Where to copy the reading</param>
+/// <returns>FALSE if the buffer is empty</returns>
+bool Si7021Continuous::peek(Si7021::Reading& out){
+
+	if(_count == 0){
+		return false;
+	}
+
+	size_t tail = _head + _capacity - _count;
+	if(tail >= _capacity){
+		tail -= _capacity;
+	}
+	out = _ring[tail];
+	return true;
+}
+
+/// <returns>Number of readings dropped because the buffer was full</returns>
+uint32_t Si7021Continuous::getDroppedCount(){
+	return _droppedCount;
+}
+
+/// <returns>Number of consecutive failed samples, up to 255</returns>
+uint8_t Si7021Continuous::getFailureStreak(){
+	return _failureStreak;
+}
+
+/// <summary>
+///		Check if the sensor keeps failing: after SI7021_FAILURE_STREAK_LIMIT consecutive failed samples it is sampled
+///		SI7021_DEMOTED_INTERVAL_FACTOR times less often. A sensor gone missing is probed again at that rate. The first
+///		good sample promotes it back.
+/// </summary>
+/// <returns>TRUE if the sensor is demoted</returns>
+bool Si7021Continuous::isDemoted(){
+	return _failureStreak >= SI7021_FAILURE_STREAK_LIMIT;
+}
+
+/// <summary>
+///		Only store the samples a filter passes, eg: a Si7021ChangeFilter so available() signals significant changes only.
+/// </summary>
+/// <param name="filter">Filter to apply, NULL to store every sample. Must outlive the sampling</param>
+void Si7021Continuous::setFilter(Si7021ChangeFilter* filter){
+	_filter = filter;
+}
+
+/// <summary>
+///		Feed a heater controller with the samples and switch the heater from poll(). Biased samples are dropped.
+/// </summary>
+/// <param name="heater">Controller of the same sensor, NULL to stop feeding it. Must outlive the sampling</param>
+void Si7021Continuous::setHeaterControl(Si7021HeaterControl* heater){
+	_heater = heater;
+}
+
+/// <returns>Sensor being sampled</returns>
+Si7021& Si7021Continuous::getSensor(){
+	return *_sensor;
+}
@@ -0,0 +1,63 @@
+/*
+  Si7021Continuous.h
+  Sample humidity and temperature at a fixed rate in the background, into a
+  ring buffer of raw readings (8 bytes each). Runs on the non-blocking API of
+  the sensor: only the sensors sampled that way pay for the buffer and its
+  bookkeeping.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_CONTINUOUS_H
+#define SI7021_CONTINUOUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Si7021.h"
+#include "Si7021Filter.h"
+#include "Si7021HeaterControl.h"
+
+//a demoted sensor, see Si7021Continuous::isDemoted(), is sampled that many times less often
+#define SI7021_DEMOTED_INTERVAL_FACTOR 8
+
+
+class Si7021Continuous
+{
+	private:
+		Si7021* _sensor;
+		Si7021::Reading* _ring;
+		size_t _capacity;
+		size_t _head;
+		size_t _count;
+		uint32_t _droppedCount;
+		uint32_t _interval;
+		uint32_t _nextSample;
+		bool _sampling;
+		bool _temperatureStep;
+		uint16_t _sampleHumidity;
+		uint8_t _failureStreak;
+		Si7021ChangeFilter* _filter;
+		Si7021HeaterControl* _heater;
+		void complete();
+		void push(const Si7021::Reading& reading);
+		void track(bool success);
+	public:
+		Si7021Continuous(Si7021& sensor);
+		bool start(Si7021::Reading* buffer, size_t capacity, uint32_t interval);
+		void stop();
+		bool isRunning();
+		Si7021::State poll();
+		size_t available();
+		size_t drain(Si7021::Reading* out, size_t max);
+		bool peek(Si7021::Reading& out);
+		uint32_t getDroppedCount();
+		uint8_t getFailureStreak();
+		bool isDemoted();
+		void setFilter(Si7021ChangeFilter* filter);
+		void setHeaterControl(Si7021HeaterControl* heater);
+		Si7021& getSensor();
+};
+
+#endif
@@ -0,0 +1,149 @@
+/*
+  Si7021Filter.cpp
+  Integer filters working on the raw codes of the sensor: exponential moving
+  average, median of N for spike rejection, oversample-and-decimate and
+  report-on-change deadbands. Codes are only converted once filtered, and
+  error codes are never fed in.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Filter.h"
+
+/// <summary>Exponential moving average of the codes</summary>
+/// <param name="shift">Weight of a new code is 1 / 2^shift, from 0 (no filtering) to 15</param>
+Si7021Ema::Si7021Ema(uint8_t shift) : _accumulator(0), _shift(shift > 15 ? 15 : shift), _primed(false) {};
+
+/// <summary>Feed a code to the filter</summary>
+/// <param name="code">Raw code. Error codes are ignored</param>
+/// <returns>FALSE if code was an error code</returns>
+bool Si7021Ema::add(uint16_t code){
+	if(SI7021_IS_ERROR(code)){
+		return false;
+	}
+
+	//the accumulator keeps shift fractional bits: no precision lost between two updates
+	if(!_primed){
+		_accumulator = (uint32_t)code << _shift;
+		_primed = true;
+	}
+	else{
+		_accumulator = _accumulator - (_accumulator >> _shift) + code;
+	}
+	return true;
+}
+
+/// <returns>Filtered code, SI7021_ERROR_NACK if no code was fed yet</returns>
+uint16_t Si7021Ema::get(){
+	if(!_primed){
+		return SI7021_ERROR_NACK;
+	}
+	return this->getFullCode() & SI7021_FILTER_CODE_MASK;
+}
+
+/// <summary>
+///		Filtered value with all 16 bits, the 2 status bits of the code holding the resolution gained by averaging.
+///		Convert it with Si7021::convertHumidity() or convertTemperature(), but don't check it with SI7021_IS_ERROR
+///		nor feed it to another filter.
+/// </summary>
+/// <returns>Filtered value as a 16 bit code, 0 if no code was fed yet</returns>
+uint16_t Si7021Ema::getFullCode(){
+	return (uint16_t)(_accumulator >> _shift);
+}
+
+/// <summary>Forget the history: the next code primes the filter</summary>
+void Si7021Ema::reset(){
+	_accumulator = 0;
+	_primed = false;
+}
+
+
+/// <summary>Oversample and decimate the codes</summary>
+/// <param name="shift">2^shift codes are averaged into one, from 0 to 15</param>
+Si7021Decimator::Si7021Decimator(uint8_t shift) : _sum(0), _count(0), _result(0), _shift(shift > 15 ? 15 : shift), _ready(false) {};
+
+/// <summary>Feed a code to the filter</summary>
+/// <param name="code">Raw code. Error codes are ignored</param>
+/// <returns>TRUE when a block is complete and get() has a new result</returns>
+bool Si7021Decimator::add(uint16_t code){
+	if(SI7021_IS_ERROR(code)){
+		return false;
+	}
+
+	_sum += code;
+	if(++_count < (1U << _shift)){
+		return false;
+	}
+
+	_result = (uint16_t)(_sum >> _shift);
+	_ready = true;
+	_sum = 0;
+	_count = 0;
+	return true;
+}
+
+/// <returns>Average of the last complete block rounded down to a valid code, SI7021_ERROR_NACK if there is none yet</returns>
+uint16_t Si7021Decimator::get(){
+	return _ready ? (uint16_t)(_result & SI7021_FILTER_CODE_MASK) : SI7021_ERROR_NACK;
+}
+
+/// <summary>
+///		Average of the last complete block with all 16 bits: 0x6000 and 0x6004 average to 0x6002.
+///		Convert it with Si7021::convertHumidity() or convertTemperature(), but don't check it with SI7021_IS_ERROR
+///		nor feed it to another filter.
+/// </summary>
+/// <returns>Average as a 16 bit code, 0 if there is none yet</returns>
+uint16_t Si7021Decimator::getFullCode(){
+	return _result;
+}
+
+/// <summary>Drop the block in progress and the last result</summary>
+void Si7021Decimator::reset(){
+	_sum = 0;
+	_count = 0;
+	_result = 0;
+	_ready = false;
+}
+
+/// <summary>Report-on-change filter. The first reading always passes</summary>
+/// <param name="humidityDeadband">Change of the humidity code to report, 0 reports every reading</param>
+/// <param name="temperatureDeadband">Change of the temperature code to report, 0 reports every reading</param>
+/// <param name="maxSilence">Pass a reading anyway when none did for that long, in milliseconds. 0 to disable</param>
+Si7021ChangeFilter::Si7021ChangeFilter(uint16_t humidityDeadband, uint16_t temperatureDeadband, uint32_t maxSilence) :
+	_humidityDeadband(humidityDeadband), _temperatureDeadband(temperatureDeadband), _maxSilence(maxSilence), _last(),
+	_reported(false), _suppressedCount(0) {};
+
+/// <summary>Compare a reading with the last one passed</summary>
+/// <param name="reading">New reading</param>
+/// <returns>TRUE if it must be reported, it then becomes the reference</returns>
+bool Si7021ChangeFilter::add(const Si7021::Reading& reading){
+
+	//against the last reported reading, not the last one seen: a slow drift is reported once it adds up to a deadband
+	bool significant = !_reported
+		|| (uint16_t)abs((int32_t)reading.humidityCode - _last.humidityCode) >= _humidityDeadband
+		|| (uint16_t)abs((int32_t)reading.temperatureCode - _last.temperatureCode) >= _temperatureDeadband
+		|| (_maxSilence && reading.timestamp - _last.timestamp >= _maxSilence);
+
+	if(!significant){
+		_suppressedCount++;
+		return false;
+	}
+	_last = reading;
+	_reported = true;
+	return true;
+}
+
+/// <returns>Number of readings held back because they were within the deadbands</returns>
+uint32_t Si7021ChangeFilter::getSuppressedCount(){
+	return _suppressedCount;
+}
+
+/// <summary>Forget the reference: the next reading passes</summary>
+void Si7021ChangeFilter::reset(){
+	_reported = false;
+	_suppressedCount = 0;
+}
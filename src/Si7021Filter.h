@@ -0,0 +1,147 @@
+/*
+  Si7021Filter.h
+  Integer filters working on the raw codes of the sensor: exponential moving
+  average, median of N for spike rejection, oversample-and-decimate and
+  report-on-change deadbands. Codes are only converted once filtered, and
+  error codes are never fed in.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_FILTER_H
+#define SI7021_FILTER_H
+
+#include <stdint.h>
+#include "Si7021.h"
+
+//get() keeps the 2 least significant bits cleared so its results are still valid codes (at most 14 significant bits).
+//getFullCode() keeps them: averaging gains resolution below the sensor's own, up to all 16 bits of the code
+#define SI7021_FILTER_CODE_MASK 0xFFFC
+
+
+/// <summary>
+///		Exponential moving average with a power of 2 weight: y += (x - y) / 2^shift. Shift and add only.
+/// </summary>
+class Si7021Ema
+{
+	private:
+		uint32_t _accumulator;
+		uint8_t _shift;
+		bool _primed;
+	public:
+		Si7021Ema(uint8_t shift = 2);
+		bool add(uint16_t code);
+		uint16_t get();
+		uint16_t getFullCode();
+		void reset();
+};
+
+
+/// <summary>
+///		Average of 2^shift consecutive codes, output once per block: trades sample rate for resolution.
+///		Codes are left aligned in 16 bits, so the bits gained land below the sensor's resolution: up to 4 at 12 bit RH,
+///		2 at 14 bit temperature. getFullCode() has them, get() rounds them off to a valid code.
+/// </summary>
+class Si7021Decimator
+{
+	private:
+		uint32_t _sum;
+		uint16_t _count;
+		uint16_t _result;
+		uint8_t _shift;
+		bool _ready;
+	public:
+		Si7021Decimator(uint8_t shift = 2);
+		bool add(uint16_t code);
+		uint16_t get();
+		uint16_t getFullCode();
+		void reset();
+};
+
+
+/// <summary>
+///		Pass a reading only when it differs from the last one passed by at least a deadband, in raw counts so no float
+///		math is involved (see SI7021_HUMIDITY_COUNTS_PER_PERCENT and SI7021_TEMPERATURE_COUNTS_PER_DEGREE).
+///		Plugs into Si7021Continuous::setFilter() so the buffer only gets significant changes.
+/// </summary>
+class Si7021ChangeFilter
+{
+	private:
+		uint16_t _humidityDeadband;
+		uint16_t _temperatureDeadband;
+		uint32_t _maxSilence;
+		Si7021::Reading _last;
+		bool _reported;
+		uint32_t _suppressedCount;
+	public:
+		Si7021ChangeFilter(uint16_t humidityDeadband, uint16_t temperatureDeadband, uint32_t maxSilence = 0);
+		bool add(const Si7021::Reading& reading);
+		uint32_t getSuppressedCount();
+		void reset();
+};
+
+
+/// <summary>
+///		Median of the last N codes, rejects isolated spikes.
+/// </summary>
+/// <typeparam name="N">Window size, odd and small: the window is sorted on each get()</typeparam>
+template <uint8_t N = 5>
+class Si7021Median
+{
+	static_assert(N > 0 && (N & 1), "N must be odd");
+
+	private:
+		uint16_t _window[N];
+		uint8_t _head;
+		uint8_t _count;
+
+	public:
+		Si7021Median() : _head(0), _count(0) {};
+
+		/// <summary>Add a code to the window</summary>
+		/// <param name="code">Raw code. Error codes are ignored</param>
+		/// <returns>TRUE once the window is full: get() has a median</returns>
+		bool add(uint16_t code) {
+			if (SI7021_IS_ERROR(code)) {
+				return false;
+			}
+			_window[_head] = code;
+			if (++_head >= N) {
+				_head = 0;
+			}
+			if (_count < N) {
+				_count++;
+			}
+			return _count == N;
+		}
+
+		/// <returns>Median of the window, of the codes so far until it is full. SI7021_ERROR_NACK if empty</returns>
+		uint16_t get() {
+			if (_count == 0) {
+				return SI7021_ERROR_NACK;
+			}
+
+			//insertion sort of a copy: a handful of elements
+			uint16_t sorted[N];
+			for (uint8_t i = 0; i < _count; i++) {
+				uint16_t value = _window[i];
+				uint8_t j = i;
+				while (j > 0 && sorted[j - 1] > value) {
+					sorted[j] = sorted[j - 1];
+					j--;
+				}
+				sorted[j] = value;
+			}
+			return sorted[_count / 2];
+		}
+
+		/// <summary>Empty the window</summary>
+		void reset() {
+			_head = 0;
+			_count = 0;
+		}
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*
+  Si7021HeaterControl.cpp
+  Drive the heater of the sensor from its humidity readings, eg: to dry a
+  condensed sensor, and flag the readings biased by the heat.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021HeaterControl.h"
+
+/// <summary>Heater controller of a sensor. The heater is left alone until start()</summary>
+/// <param name="sensor">Sensor to drive, already started with begin()</param>
+Si7021HeaterControl::Si7021HeaterControl(Si7021& sensor) :
+	_sensor(&sensor), _threshold(0), _power(0), _duration(0), _until(0), _discardCount(0), _discard(0), _active(false),
+	_fresh(false), _lastHumidity(0) {};
+
+/// <summary>
+///		Start driving the heater: when a reading given to add() reaches humidityCenti, poll() turns the heater on at
+///		power for duration seconds, then off. The readings taken while heating and the next discard ones are biased by
+///		the heat. Each transition is a single register write, the heater power only needs one when it changes.
+///		Si7021Continuous::setHeaterControl() feeds and polls the controller with its samples.
+/// </summary>
+/// <param name="humidityCenti">Relative Humidity turning the heater on, in hundredths of a percent</param>
+/// <param name="power">Strength of the heater, see Si7021::setHeater()</param>
+/// <param name="duration">Time the heater stays on, in seconds</param>
+/// <param name="discard">Number of readings still biased once the heater is off</param>
+void Si7021HeaterControl::start(uint16_t humidityCenti, uint8_t power, uint16_t duration, uint8_t discard){
+	if(humidityCenti > 10000){
+		humidityCenti = 10000;
+	}
+
+	//compared with the raw codes: inverse of the humidity conversion, never 0
+	_threshold = (uint16_t)(((uint32_t)(humidityCenti + 600) << 16) / 12500);
+	_power = power;
+	_duration = duration * 1000UL;
+	_discardCount = discard;
+	_fresh = false;
+}
+
+/// <summary>
+///		Stop driving the heater, and turn it off if the controller had it on.
+/// </summary>
+/// <returns>FALSE if the heater could not be turned off, see Si7021::getStatus()</returns>
+bool Si7021HeaterControl::stop(){
+	_threshold = 0;
+	if(!_active){
+		return true;
+	}
+	if(!_sensor->setHeater(false)){
+		return false;
+	}
+	_active = false;
+	_discard = _discardCount;
+	return true;
+}
+
+/// <summary>
+///		Feed the controller with a reading just taken. Such readings are higher in temperature and lower in humidity
+///		while heating and right after.
+/// </summary>
+/// <param name="reading">Last reading of the sensor</param>
+/// <returns>FALSE if the reading is biased by the heat and should not be trusted</returns>
+bool Si7021HeaterControl::add(const Si7021::Reading& reading){
+
+	//taken with the heater on, or too soon after it went off
+	if(_active){
+		return false;
+	}
+	if(_discard > 0){
+		_discard--;
+		return false;
+	}
+
+	_lastHumidity = reading.humidityCode;
+	_fresh = true;
+	return true;
+}
+
+/// <summary>
+///		Switch the heater on when the last reading crossed the threshold, and off once the heating time is over.
+///		Never blocks: call it from your main loop, after add().
+/// </summary>
+void Si7021HeaterControl::poll(){
+
+	//the sensor NACKs register writes during a conversion. A heater stop() could not turn off still goes off in time
+	if((!_threshold && !_active) || _sensor->getState() == Si7021::STATE_CONVERTING){
+		return;
+	}
+
+	if(_active){
+		_fresh = false;
+		if((int32_t)(_sensor->getMillis() - _until) >= 0 && _sensor->setHeater(false)){
+			_active = false;
+			_discard = _discardCount;
+		}
+		return;
+	}
+
+	if(!_fresh){
+		return;
+	}
+	_fresh = false;
+
+	if(_lastHumidity >= _threshold && _sensor->setHeater(true, _power)){
+		_active = true;
+		_until = _sensor->getMillis() + _duration;
+	}
+}
+
+/// <returns>TRUE while the controller has the heater on</returns>
+bool Si7021HeaterControl::isHeating(){
+	return _active;
+}
@@ -0,0 +1,40 @@
+/*
+  Si7021HeaterControl.h
+  Drive the heater of the sensor from its humidity readings, eg: to dry a
+  condensed sensor, and flag the readings biased by the heat.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_HEATER_CONTROL_H
+#define SI7021_HEATER_CONTROL_H
+
+#include <stdint.h>
+#include "Si7021.h"
+
+
+class Si7021HeaterControl
+{
+	private:
+		Si7021* _sensor;
+		uint16_t _threshold;
+		uint8_t _power;
+		uint32_t _duration;
+		uint32_t _until;
+		uint8_t _discardCount;
+		uint8_t _discard;
+		bool _active;
+		bool _fresh;
+		uint16_t _lastHumidity;
+	public:
+		Si7021HeaterControl(Si7021& sensor);
+		void start(uint16_t humidityCenti, uint8_t power, uint16_t duration, uint8_t discard = 2);
+		bool stop();
+		bool add(const Si7021::Reading& reading);
+		void poll();
+		bool isHeating();
+};
+
+#endif
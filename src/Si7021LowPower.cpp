@@ -0,0 +1,142 @@
+/*
+  Si7021LowPower.cpp
+  Blocking measurements that sleep through the conversions instead of busy
+  waiting, with an estimate of the energy each one took: the MCU is only awake
+  for the bus transactions.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021LowPower.h"
+
+/// <summary>
+///		Sleep through the conversions of a sensor. Best used with READY_TIMED: in READY_NACK_POLLING mode the MCU wakes
+///		up every poll interval, and READY_HOLD_MASTER can't sleep at all. millis() timestamps lag by any time the clock
+///		missed during sleep.
+/// </summary>
+/// <param name="sensor">Sensor to measure, already started with begin()</param>
+/// <param name="sleep">Called with the time to sleep, in microseconds</param>
+/// <param name="context">User pointer passed as is to sleep</param>
+Si7021LowPower::Si7021LowPower(Si7021& sensor, Si7021SleepCallback sleep, void* context) :
+	_sensor(&sensor), _sleep(sleep), _sleepContext(context), _supplyVoltage(3300), _awakeCurrent(0), _sleepCurrent(0),
+	_awakeTime(0), _sleepTime(0), _sensorEnergy(0) {};
+
+/// <summary>
+///		Describe the power supply of the node so getLastEnergy() can account for the MCU as well as the sensor.
+///		Defaults to 3300mV and 0uA: only the sensor is accounted for.
+/// </summary>
+/// <param name="supplyVoltage">Supply voltage, in millivolts</param>
+/// <param name="awakeCurrent">Current drawn by the MCU while awake, in microamps</param>
+/// <param name="sleepCurrent">Current drawn by the MCU in the sleep state entered by the sleep hook, in microamps</param>
+void Si7021LowPower::setPowerProfile(uint16_t supplyVoltage, uint16_t awakeCurrent, uint16_t sleepCurrent){
+	_supplyVoltage = supplyVoltage;
+	_awakeCurrent = awakeCurrent;
+	_sleepCurrent = sleepCurrent;
+}
+
+/// <summary>
+///		Measure the humidity and the temperature converted along with it, see Si7021::measure(), sleeping through the
+///		conversions. On a part without temperature read back (VARIANT_SHT2X) the temperature takes a second conversion.
+///		Fails with STATUS_BUSY while a non-blocking measurement is in progress or its result is not collected yet.
+/// </summary>
+/// <param name="reading">Raw codes and timestamp of the measurement. Left untouched on error</param>
+/// <returns>STATUS_OK, or what went wrong</returns>
+Si7021::Status Si7021LowPower::measure(Si7021::Reading& reading){
+
+	//the pending result would be overwritten
+	Si7021::State state = _sensor->getState();
+	if(state == Si7021::STATE_CONVERTING || state == Si7021::STATE_READY){
+		return Si7021::STATUS_BUSY;
+	}
+
+	uint16_t rh, t;
+	_awakeTime = 0;
+	_sleepTime = 0;
+	_sensorEnergy = 0;
+
+	if(this->convert(true, rh) != Si7021::STATUS_OK){
+		return _sensor->getStatus();
+	}
+
+	if(_sensor->canReadBack()){
+		//the temperature is only read again if its read back failed
+		t = _sensor->getReadBackTemperatureRaw();
+		if(SI7021_IS_ERROR(t)){
+			t = _sensor->getTemperatureFromPreviousHumidityMeasurementRaw();
+			if(SI7021_IS_ERROR(t)){
+				return _sensor->getStatus();
+			}
+		}
+	}
+	else if(this->convert(false, t) != Si7021::STATUS_OK){
+		return _sensor->getStatus();
+	}
+
+	reading.humidityCode = rh;
+	reading.temperatureCode = t;
+	reading.timestamp = _sensor->getMillis();
+	return Si7021::STATUS_OK;
+}
+
+/// <summary>One conversion on the non-blocking API, sleeping until each read attempt</summary>
+/// <param name="humidity">TRUE for a humidity conversion with temperature read back, FALSE for a temperature one</param>
+/// <param name="value">Read result</param>
+/// <returns>Status of the conversion</returns>
+Si7021::Status Si7021LowPower::convert(bool humidity, uint16_t& value){
+
+	uint32_t start = _sensor->getMicros();
+	if(!(humidity ? _sensor->startHumidityMeasurement(true) : _sensor->startTemperatureMeasurement())){
+		return _sensor->getStatus();
+	}
+
+	//microamps times microseconds: picocoulombs
+	_sensorEnergy += (uint32_t)(humidity ? SI7021_HUMIDITY_CONVERSION_CURRENT : SI7021_TEMPERATURE_CONVERSION_CURRENT) * _sensor->getLastConversionTime();
+
+	uint32_t seen = 0;
+	while(_sensor->poll() == Si7021::STATE_CONVERTING){
+		uint32_t wait = _sensor->getWaitTime();
+		if(wait == 0){
+			continue;
+		}
+
+		uint32_t before = _sensor->getMicros();
+		uint32_t slept = _sleep(wait, _sleepContext);
+		uint32_t elapsed = _sensor->getMicros() - before;
+		seen += elapsed;
+		_sleepTime += slept;
+
+		//deep sleep modes usually stop the timer behind micros(): account for the missing time
+		if(slept > elapsed){
+			_sensor->addElapsedTime(slept - elapsed);
+		}
+	}
+	_awakeTime += (_sensor->getMicros() - start) - seen;
+
+	value = _sensor->getRawResult();
+	return _sensor->getStatus();
+}
+
+/// <returns>Time the MCU spent awake in the last measurement, in microseconds</returns>
+uint32_t Si7021LowPower::getLastAwakeTime(){
+	return _awakeTime;
+}
+
+/// <returns>Time the MCU spent in the sleep hook during the last measurement, in microseconds</returns>
+uint32_t Si7021LowPower::getLastSleepTime(){
+	return _sleepTime;
+}
+
+/// <summary>
+///		Estimate the energy spent by the last measurement: the sensor converting at its typical current, plus the MCU
+///		awake and asleep as described by setPowerProfile().
+/// </summary>
+/// <returns>Energy, in microjoules</returns>
+float Si7021LowPower::getLastEnergy(){
+	float charge = (float)_awakeTime * _awakeCurrent + (float)_sleepTime * _sleepCurrent + _sensorEnergy;
+	//picocoulombs times millivolts: 1e-15 J
+	return charge * _supplyVoltage * 1e-9f;
+}
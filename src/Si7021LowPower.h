@@ -0,0 +1,49 @@
+/*
+  Si7021LowPower.h
+  Blocking measurements that sleep through the conversions instead of busy
+  waiting, with an estimate of the energy each one took: the MCU is only awake
+  for the bus transactions.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_LOW_POWER_H
+#define SI7021_LOW_POWER_H
+
+#include <stdint.h>
+#include "Si7021.h"
+
+//typical supply current of the sensor while converting, from the datasheet, in microamps. Used for the energy estimate
+#define SI7021_HUMIDITY_CONVERSION_CURRENT 150
+#define SI7021_TEMPERATURE_CONVERSION_CURRENT 90
+
+//put the MCU to sleep for about duration microseconds. Returns the time actually slept, in microseconds, so the
+//driver can make up for a micros() clock stopped during sleep
+typedef uint32_t (*Si7021SleepCallback)(uint32_t duration, void* context);
+
+
+class Si7021LowPower
+{
+	private:
+		Si7021* _sensor;
+		Si7021SleepCallback _sleep;
+		void* _sleepContext;
+		uint16_t _supplyVoltage;
+		uint16_t _awakeCurrent;
+		uint16_t _sleepCurrent;
+		uint32_t _awakeTime;
+		uint32_t _sleepTime;
+		uint32_t _sensorEnergy;
+		Si7021::Status convert(bool humidity, uint16_t& value);
+	public:
+		Si7021LowPower(Si7021& sensor, Si7021SleepCallback sleep, void* context = NULL);
+		void setPowerProfile(uint16_t supplyVoltage, uint16_t awakeCurrent, uint16_t sleepCurrent);
+		Si7021::Status measure(Si7021::Reading& reading);
+		uint32_t getLastAwakeTime();
+		uint32_t getLastSleepTime();
+		float getLastEnergy();
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+  Si7021Mux.cpp
+  TCA9548A (and PCA9548A) I2C multiplexer, so several Si7021 sensors sharing
+  address 0x40 can be driven from one bus. The selected channels are cached:
+  the control register is only written when they change.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Mux.h"
+
+/// <param name="wire">Bus the multiplexer is on</param>
+/// <param name="address">Address of the multiplexer, set by its A0-A2 pins</param>
+Si7021Mux::Si7021Mux(TwoWire& wire, uint8_t address) :
+	_wireBus(wire), _bus(NULL), _address(address), _selected(0), _known(false), _switches(0) {};
+
+/// <param name="bus">Bus the multiplexer is on, eg: the one given to the sensors. Must outlive this object</param>
+/// <param name="address">Address of the multiplexer, set by its A0-A2 pins</param>
+Si7021Mux::Si7021Mux(Si7021Bus& bus, uint8_t address) :
+	_wireBus(Wire), _bus(&bus), _address(address), _selected(0), _known(false), _switches(0) {};
+
+Si7021Bus& Si7021Mux::bus(){
+	return _bus ? *_bus : _wireBus;
+}
+
+/// <summary>
+///		Connect the downstream buses in mask, disconnect the others. No bus traffic if they already are.
+///		Call invalidate() if something else writes to the multiplexer.
+/// </summary>
+/// <param name="mask">Bit n set to connect channel n</param>
+/// <returns>FALSE if the multiplexer did not answer</returns>
+bool Si7021Mux::select(uint8_t mask){
+
+	if(_known && _selected == mask){
+		return true;
+	}
+
+	_switches++;
+	if(this->bus().write(_address, &mask, 1, true) != 0){
+		_known = false;
+		return false;
+	}
+
+	_selected = mask;
+	_known = true;
+	return true;
+}
+
+/// <summary>
+///		Write an instruction to the devices at the same address on several channels in one transaction.
+///		The devices acknowledge together, so a missing one goes unnoticed until it is read.
+/// </summary>
+/// <param name="mask">Channels to write to</param>
+/// <param name="address">Address of the devices, eg: SI7021_ADDRESS</param>
+/// <param name="instr">Instruction to write</param>
+/// <returns>FALSE if the multiplexer or all of the devices did not answer</returns>
+bool Si7021Mux::broadcast(uint8_t mask, uint8_t address, uint8_t instr){
+	return this->select(mask) && this->bus().write(address, &instr, 1, true) == 0;
+}
+
+/// <summary>Forget the cached selection: the next select() writes the control register</summary>
+void Si7021Mux::invalidate(){
+	_known = false;
+}
+
+/// <returns>Mask of the channels last selected</returns>
+uint8_t Si7021Mux::getSelected(){
+	return _selected;
+}
+
+/// <returns>Number of writes to the control register since construction</returns>
+uint32_t Si7021Mux::getSwitchCount(){
+	return _switches;
+}
+
+/// <summary>
+///		Select callback for Si7021::setMuxChannel, connecting only the sensor's channel:
+///		sensor.setMuxChannel(Si7021Mux::selectChannel, channel, &mux)
+/// </summary>
+/// <param name="channel">Channel of the sensor, 0 to 7</param>
+/// <param name="context">The Si7021Mux</param>
+void Si7021Mux::selectChannel(uint8_t channel, void* context){
+	static_cast<Si7021Mux*>(context)->select((uint8_t)(1 << channel));
+}
@@ -0,0 +1,45 @@
+/*
+  Si7021Mux.h
+  TCA9548A (and PCA9548A) I2C multiplexer, so several Si7021 sensors sharing
+  address 0x40 can be driven from one bus. The selected channels are cached:
+  the control register is only written when they change.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_MUX_H
+#define SI7021_MUX_H
+
+#include <stdint.h>
+#include <Wire.h>
+#include "Si7021Bus.h"
+
+//default address of the TCA9548A (A0, A1 and A2 low). Up to 0x77
+#define SI7021_MUX_ADDRESS 0x70
+#define SI7021_MUX_CHANNELS 8
+
+
+class Si7021Mux
+{
+	private:
+		Si7021WireBus _wireBus;
+		Si7021Bus* _bus;
+		uint8_t _address;
+		uint8_t _selected;
+		bool _known;
+		uint32_t _switches;
+		Si7021Bus& bus();
+	public:
+		Si7021Mux(TwoWire& wire = Wire, uint8_t address = SI7021_MUX_ADDRESS);
+		Si7021Mux(Si7021Bus& bus, uint8_t address = SI7021_MUX_ADDRESS);
+		bool select(uint8_t mask);
+		bool broadcast(uint8_t mask, uint8_t address, uint8_t instr);
+		void invalidate();
+		uint8_t getSelected();
+		uint32_t getSwitchCount();
+		static void selectChannel(uint8_t channel, void* context);
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*
+  Si7021Psychrometrics.cpp
+  Vapour pressure, dew point and absolute humidity from a single humidity and
+  temperature reading, in fixed point: one table lookup, no logf/expf.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Psychrometrics.h"
+
+//saturation vapour pressure over water, in decipascal, every 2 C from -40 C: 611.2 * exp(17.62 * T / (243.12 + T)) * 10
+#define SI7021_PSYCHROMETRICS_MIN -4000
+#define SI7021_PSYCHROMETRICS_STEP 200
+#define SI7021_PSYCHROMETRICS_SIZE 84
+static const uint32_t SI7021_SATURATION_PRESSURE[SI7021_PSYCHROMETRICS_SIZE] PROGMEM = {
+	190, 234, 286, 348, 423, 512, 617, 741,	//-40 to -26 C
+	887, 1059, 1260, 1494, 1766, 2083, 2448, 2870,	//-24 to -10 C
+	3356, 3913, 4552, 5281, 6112, 7057, 8129, 9343,	//-8 to 6 C
+	10714, 12260, 14000, 15953, 18142, 20591, 23326, 26374,	//8 to 22 C
+	29766, 33533, 37711, 42337, 47450, 53094, 59313, 66156,	//24 to 38 C
+	73675, 81924, 90963, 100852, 111659, 123452, 136304, 150294,	//40 to 54 C
+	165504, 182020, 199933, 219338, 240337, 263035, 287543, 313977,	//56 to 70 C
+	342458, 373114, 406077, 441487, 479489, 520232, 563875, 610581,	//72 to 86 C
+	660520, 713870, 770814, 831542, 896253, 965151, 1038449, 1116366,	//88 to 102 C
+	1199129, 1286972, 1380139, 1478879, 1583450, 1694119, 1811159, 1934852,	//104 to 118 C
+	2065490, 2203370, 2348799, 2502094	//120 to 126 C
+};
+
+/// <summary>Derive the quantities from raw codes</summary>
+/// <param name="humidityCode">Raw humidity code</param>
+/// <param name="temperatureCode">Raw code of the temperature converted along with the humidity</param>
+Si7021Psychrometrics::Si7021Psychrometrics(uint16_t humidityCode, uint16_t temperatureCode){
+	this->compute(humidityCode, temperatureCode);
+}
+
+/// <summary>Derive the quantities from a reading of measure() or of continuous sampling</summary>
+/// <param name="reading">Humidity and temperature of the same conversion</param>
+Si7021Psychrometrics::Si7021Psychrometrics(const Si7021::Reading& reading){
+	this->compute(reading.humidityCode, reading.temperatureCode);
+}
+
+void Si7021Psychrometrics::compute(uint16_t humidityCode, uint16_t temperatureCode){
+
+	temperature = Si7021::convertTemperatureCenti(temperatureCode);
+	humidity = Si7021::convertHumidityCenti(humidityCode);
+
+	uint32_t saturation = getSaturationPressure(temperature);
+
+	//saturation * humidity / 10000 without overflowing 32 bits
+	uint32_t vapour = (saturation / 10000) * humidity + (saturation % 10000) * humidity / 10000;
+
+	saturationPressure = (saturation + 5) / 10;
+	vapourPressure = (vapour + 5) / 10;
+	dewPoint = getDewPoint(vapour);
+
+	//ideal gas law: e / (Rv * T) with Rv = 461.5 J/(kg.K). In decipascal, decikelvin and centigram: 1e5 / 461.5 = 216.68 ~ 867 / 4
+	uint32_t kelvin = ((int32_t)temperature + 27315) / 10;
+	uint32_t absolute = ((vapour * 867UL) >> 2) / kelvin;
+	absoluteHumidity = absolute > 0xFFFF ? 0xFFFF : (uint16_t)absolute;
+}
+
+/// <summary>Saturation vapour pressure, interpolated from the table</summary>
+/// <param name="temperature">Temperature, in hundredths of a degree Celcius. Clamped to the table</param>
+/// <returns>Saturation vapour pressure, in decipascal</returns>
+uint32_t Si7021Psychrometrics::getSaturationPressure(int16_t temperature){
+
+	int32_t offset = (int32_t)temperature - SI7021_PSYCHROMETRICS_MIN;
+	if(offset < 0){
+		offset = 0;
+	}
+
+	uint16_t index = offset / SI7021_PSYCHROMETRICS_STEP;
+	if(index >= SI7021_PSYCHROMETRICS_SIZE - 1){
+		return pgm_read_dword(&SI7021_SATURATION_PRESSURE[SI7021_PSYCHROMETRICS_SIZE - 1]);
+	}
+
+	uint32_t low = pgm_read_dword(&SI7021_SATURATION_PRESSURE[index]);
+	uint32_t high = pgm_read_dword(&SI7021_SATURATION_PRESSURE[index + 1]);
+	return low + (high - low) * (offset % SI7021_PSYCHROMETRICS_STEP) / SI7021_PSYCHROMETRICS_STEP;
+}
+
+/// <summary>Dew point: temperature at which the vapour pressure is the saturation pressure. Reverse lookup of the table</summary>
+/// <param name="vapourPressure">Vapour pressure, in decipascal</param>
+/// <returns>Dew point, in hundredths of a degree Celcius, clamped to the table</returns>
+int16_t Si7021Psychrometrics::getDewPoint(uint32_t vapourPressure){
+
+	uint8_t low = 0;
+	uint8_t high = SI7021_PSYCHROMETRICS_SIZE - 1;
+
+	if(vapourPressure <= pgm_read_dword(&SI7021_SATURATION_PRESSURE[low])){
+		return SI7021_PSYCHROMETRICS_MIN;
+	}
+	if(vapourPressure >= pgm_read_dword(&SI7021_SATURATION_PRESSURE[high])){
+		return SI7021_PSYCHROMETRICS_MIN + high * SI7021_PSYCHROMETRICS_STEP;
+	}
+
+	//the table is increasing: binary search, 7 steps
+	while(high - low > 1){
+		uint8_t middle = (low + high) / 2;
+		if(pgm_read_dword(&SI7021_SATURATION_PRESSURE[middle]) <= vapourPressure){
+			low = middle;
+		}
+		else{
+			high = middle;
+		}
+	}
+
+	uint32_t below = pgm_read_dword(&SI7021_SATURATION_PRESSURE[low]);
+	uint32_t above = pgm_read_dword(&SI7021_SATURATION_PRESSURE[high]);
+	return SI7021_PSYCHROMETRICS_MIN + low * SI7021_PSYCHROMETRICS_STEP + (int16_t)((vapourPressure - below) * SI7021_PSYCHROMETRICS_STEP / (above - below));
+}
@@ -0,0 +1,145 @@
+/*
+  Si7021Retry.cpp
+  Blocking measurements retried on transient NACKs and checksum errors, within
+  a latency budget, with a failure streak that demotes a sensor that keeps
+  failing.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Retry.h"
+
+/// <summary>
+///		Retry the reads of a sensor that failed on a transient NACK or checksum error, instead of returning an error
+///		code. A failed temperature read back costs one more short transaction; a corrupted conversion result is gone
+///		from the sensor and needs a new conversion. The budget caps the time a call may take, retries that would
+///		overrun it are not made. A demoted sensor, see isDemoted(), is not retried.
+/// </summary>
+/// <param name="sensor">Sensor to measure, already started with begin()</param>
+/// <param name="retries">Retries per read, 0 to only track the failure streak</param>
+/// <param name="backoff">Wait before the first retry, doubled for each next one, in microseconds</param>
+/// <param name="budget">Maximum duration of a read retries included, in microseconds. 0 for no limit</param>
+Si7021Retry::Si7021Retry(Si7021& sensor, uint8_t retries, uint16_t backoff, uint32_t budget) :
+	_sensor(&sensor), _retries(retries), _backoff(backoff), _budget(budget), _failureStreak(0), _retryCount(0) {};
+
+/// <summary>
+///		Measure the humidity then get the temperature converted along with it, each retried on its own: a failed
+///		temperature read doesn't cost a new humidity conversion. See Si7021::measure().
+/// </summary>
+/// <param name="reading">Raw codes and timestamp of the measurement. Left untouched on error</param>
+/// <returns>STATUS_OK, or what went wrong after the retries</returns>
+Si7021::Status Si7021Retry::measure(Si7021::Reading& reading){
+
+	uint16_t rh = this->measureHumidityRaw();
+	if(SI7021_IS_ERROR(rh)){
+		return _sensor->getStatus();
+	}
+	uint16_t t = this->getTemperatureFromPreviousHumidityMeasurementRaw();
+	if(SI7021_IS_ERROR(t)){
+		return _sensor->getStatus();
+	}
+
+	reading.humidityCode = rh;
+	reading.temperatureCode = t;
+	reading.timestamp = _sensor->getMillis();
+	return Si7021::STATUS_OK;
+}
+
+/// <summary>See Si7021::measureHumidityRaw()</summary>
+/// <returns>Raw humidity code, one of the SI7021_ERROR_ codes on error</returns>
+uint16_t Si7021Retry::measureHumidityRaw(){
+	return this->run(&Si7021::measureHumidityRaw, true);
+}
+
+/// <summary>See Si7021::measureTemperatureRaw()</summary>
+/// <returns>Raw temperature code, one of the SI7021_ERROR_ codes on error</returns>
+uint16_t Si7021Retry::measureTemperatureRaw(){
+	return this->run(&Si7021::measureTemperatureRaw, true);
+}
+
+/// <summary>See Si7021::getTemperatureFromPreviousHumidityMeasurementRaw()</summary>
+/// <returns>Raw temperature code, one of the SI7021_ERROR_ codes on error</returns>
+uint16_t Si7021Retry::getTemperatureFromPreviousHumidityMeasurementRaw(){
+	//parts without temperature read back make a conversion instead
+	return this->run(&Si7021::getTemperatureFromPreviousHumidityMeasurementRaw, !_sensor->canReadBack());
+}
+
+/// <summary>Make a read, and make it again while it fails and the policy allows</summary>
+/// <param name="read">Blocking raw read of the sensor</param>
+/// <param name="conversion">TRUE if the read takes a conversion, FALSE for a single short transaction</param>
+/// <returns>Code of the last attempt</returns>
+uint16_t Si7021Retry::run(RawRead read, bool conversion){
+
+	uint32_t start = _sensor->getMicros();
+	uint32_t backoff = _backoff;
+	for(uint8_t attempt = 0; ; attempt++){
+		uint16_t code = (_sensor->*read)();
+		Si7021::Status status = _sensor->getStatus();
+		this->track(status);
+		if(!this->retry(status, attempt, start, backoff, conversion ? _sensor->getLastConversionTime() : 0)){
+			return code;
+		}
+	}
+}
+
+/// <summary>Decide if a failed read is worth another attempt, and wait for the backoff if so</summary>
+/// <param name="status">Outcome of the attempt</param>
+/// <param name="attempt">Number of the attempt, from 0</param>
+/// <param name="start">getMicros() when the first attempt started</param>
+/// <param name="backoff">Wait before the retry, doubled for the next one</param>
+/// <param name="cost">Time the retry itself takes, eg: the conversion time</param>
+/// <returns>TRUE to try again</returns>
+bool Si7021Retry::retry(Si7021::Status status, uint8_t attempt, uint32_t start, uint32_t& backoff, uint32_t cost){
+
+	//only transient failures: a missing sensor, a timeout or a busy state machine won't go away by retrying
+	if(status != Si7021::STATUS_NACK && status != Si7021::STATUS_CRC_ERROR){
+		return false;
+	}
+	if(attempt >= _retries || this->isDemoted()){
+		return false;
+	}
+	if(_budget && (_sensor->getMicros() - start) + backoff + cost > _budget){
+		return false;
+	}
+
+	_retryCount++;
+	if(backoff){
+		_sensor->wait(backoff);
+		backoff <<= 1;
+	}
+	return true;
+}
+
+/// <summary>Keep track of consecutive failures</summary>
+/// <param name="status">Outcome of a read</param>
+void Si7021Retry::track(Si7021::Status status){
+	if(status == Si7021::STATUS_OK){
+		_failureStreak = 0;
+	}
+	else if(status != Si7021::STATUS_BUSY && _failureStreak < 0xFF){
+		_failureStreak++;
+	}
+}
+
+/// <returns>Number of consecutive failed reads, up to 255</returns>
+uint8_t Si7021Retry::getFailureStreak(){
+	return _failureStreak;
+}
+
+/// <summary>
+///		Check if the sensor keeps failing: after SI7021_FAILURE_STREAK_LIMIT consecutive failures it is no longer
+///		retried. The first success promotes it back.
+/// </summary>
+/// <returns>TRUE if the sensor is demoted</returns>
+bool Si7021Retry::isDemoted(){
+	return _failureStreak >= SI7021_FAILURE_STREAK_LIMIT;
+}
+
+/// <returns>Number of reads made again since construction</returns>
+uint32_t Si7021Retry::getRetryCount(){
+	return _retryCount;
+}
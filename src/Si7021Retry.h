@@ -0,0 +1,43 @@
+/*
+  Si7021Retry.h
+  Blocking measurements retried on transient NACKs and checksum errors, within
+  a latency budget, with a failure streak that demotes a sensor that keeps
+  failing.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_RETRY_H
+#define SI7021_RETRY_H
+
+#include <stdint.h>
+#include "Si7021.h"
+
+
+class Si7021Retry
+{
+	private:
+		typedef uint16_t (Si7021::*RawRead)();
+		Si7021* _sensor;
+		uint8_t _retries;
+		uint16_t _backoff;
+		uint32_t _budget;
+		uint8_t _failureStreak;
+		uint32_t _retryCount;
+		uint16_t run(RawRead read, bool conversion);
+		bool retry(Si7021::Status status, uint8_t attempt, uint32_t start, uint32_t& backoff, uint32_t cost);
+		void track(Si7021::Status status);
+	public:
+		Si7021Retry(Si7021& sensor, uint8_t retries, uint16_t backoff = 0, uint32_t budget = 0);
+		Si7021::Status measure(Si7021::Reading& reading);
+		uint16_t measureHumidityRaw();
+		uint16_t measureTemperatureRaw();
+		uint16_t getTemperatureFromPreviousHumidityMeasurementRaw();
+		uint8_t getFailureStreak();
+		bool isDemoted();
+		uint32_t getRetryCount();
+};
+
+#endif
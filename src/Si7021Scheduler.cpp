@@ -0,0 +1,214 @@
+/*
+  Si7021Scheduler.cpp
+  Sample temperature and humidity at different rates, with the fewest conversions:
+  a humidity conversion brings the temperature along with it, temperature only
+  conversions run at their own, usually lower, resolution.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021Scheduler.h"
+
+/// <summary>Schedule the measurements of a sensor. Nothing is sampled until a plan is set</summary>
+/// <param name="sensor">Sensor to drive, already started with begin(). Don't sample it with a Si7021Continuous at the same time</param>
+Si7021Scheduler::Si7021Scheduler(Si7021& sensor) :
+	_sensor(&sensor), _temperatureInterval(0), _temperatureMaxDelay(0), _temperatureResolution(0),
+	_humidityInterval(0), _humidityMaxDelay(0), _humidityResolution(0), _temperatureDue(0), _humidityDue(0),
+	_temperatureTime(0), _humidityTime(0), _temperatureCode(0), _humidityCode(0), _sampled(0), _pending(0), _startTime(0) {};
+
+/// <summary>
+///		Sample the temperature every interval. Humidity conversions count as temperature samples: temperature only
+///		conversions are made in between, at their own resolution.
+/// </summary>
+/// <param name="interval">Time between two samples, in milliseconds. 0 to stop sampling the temperature</param>
+/// <param name="maxDelay">How late a sample may be, in milliseconds, to be taken by a humidity conversion due by then. 0 to keep the rate exact</param>
+/// <param name="resolution">Resolution of temperature only conversions, see Si7021::setSensorResolution(). 1 (12 bit) by default, 3.8ms</param>
+void Si7021Scheduler::setTemperaturePlan(uint32_t interval, uint32_t maxDelay, uint8_t resolution){
+	_temperatureInterval = interval;
+	_temperatureMaxDelay = maxDelay;
+	_temperatureResolution = resolution;
+	_temperatureDue = _sensor->getMillis();
+}
+
+/// <summary>Sample the humidity, and the temperature along with it, every interval</summary>
+/// <param name="interval">Time between two samples, in milliseconds. 0 to stop sampling the humidity</param>
+/// <param name="maxDelay">
+///		How late a sample may be, in milliseconds, to wait for the next temperature sample and make a single conversion
+///		of both. Up to the temperature interval saves a temperature only conversion every humidity sample. 0 to keep the rate exact
+/// </param>
+/// <param name="resolution">Resolution of humidity conversions, 0 (12 bit RH, 14 bit temperature) by default</param>
+void Si7021Scheduler::setHumidityPlan(uint32_t interval, uint32_t maxDelay, uint8_t resolution){
+	_humidityInterval = interval;
+	_humidityMaxDelay = maxDelay;
+	_humidityResolution = resolution;
+	_humidityDue = _sensor->getMillis();
+}
+
+/// <summary>
+///		Collect the conversion in progress, then start the next one if a sample is due. Never blocks, call it from your main loop.
+///		When both quantities are due a single humidity conversion is made, the temperature being read back from it.
+///		The resolution is switched through the register shadow: the bus is only used when it changes.
+/// </summary>
+/// <returns>SI7021_SCHEDULER_TEMPERATURE and/or SI7021_SCHEDULER_HUMIDITY if a new value came in, 0 otherwise</returns>
+uint8_t Si7021Scheduler::poll(){
+
+	uint8_t updated = 0;
+
+	if(_pending){
+		Si7021::State state = _sensor->poll();
+		if(state == Si7021::STATE_CONVERTING){
+			return 0;
+		}
+		updated = this->collect(state == Si7021::STATE_READY);
+	}
+
+	this->schedule();
+	return updated;
+}
+
+/// <summary>
+///		Store the result of the conversion that just completed. A humidity result without its temperature
+///		(VARIANT_SHT2X, or a failed read back) is followed by a temperature only conversion, collected by the next polls.
+/// </summary>
+/// <param name="ready">FALSE if it timed out or failed its checksum</param>
+/// <returns>Quantities updated</returns>
+uint8_t Si7021Scheduler::collect(bool ready){
+
+	uint8_t updated = 0;
+	uint16_t code = _sensor->getRawResult();
+	uint8_t pending = 0;
+
+	if(ready && (_pending & SI7021_SCHEDULER_HUMIDITY)){
+		_humidityCode = code;
+		_humidityTime = _startTime;
+		updated = SI7021_SCHEDULER_HUMIDITY;
+
+		//normally read back right after the humidity, by poll()
+		uint16_t temperature = _sensor->getReadBackTemperatureRaw();
+		if(!SI7021_IS_ERROR(temperature)){
+			_temperatureCode = temperature;
+			_temperatureTime = _startTime;
+			updated |= SI7021_SCHEDULER_TEMPERATURE;
+		}
+		else if(_sensor->startTemperatureMeasurement()){
+			pending = SI7021_SCHEDULER_TEMPERATURE;
+			_startTime = _sensor->getMillis();
+		}
+	}
+	else if(ready){
+		_temperatureCode = code;
+		_temperatureTime = _startTime;
+		updated = SI7021_SCHEDULER_TEMPERATURE;
+	}
+
+	_sampled |= updated;
+	_pending = pending;
+	return updated;
+}
+
+/// <summary>Check if a sample due can be put off until another one</summary>
+/// <param name="due">When the sample was due</param>
+/// <param name="maxDelay">How late it may be</param>
+/// <param name="until">When the other quantity is due</param>
+/// <returns>TRUE if the sample is not too late by then</returns>
+bool Si7021Scheduler::canWait(uint32_t due, uint32_t maxDelay, uint32_t until){
+	return (int32_t)(due + maxDelay - until) >= 0;
+}
+
+/// <summary>Start the cheapest conversion covering what is due</summary>
+void Si7021Scheduler::schedule(){
+
+	uint32_t now = _sensor->getMillis();
+	bool humidityDue = _humidityInterval && (int32_t)(now - _humidityDue) >= 0;
+	bool temperatureDue = _temperatureInterval && (int32_t)(now - _temperatureDue) >= 0;
+
+	//whatever is due alone may wait for the other one, to be converted together
+	if(humidityDue && !temperatureDue && _temperatureInterval && this->canWait(_humidityDue, _humidityMaxDelay, _temperatureDue)){
+		humidityDue = false;
+	}
+	if(temperatureDue && !humidityDue && _humidityInterval && this->canWait(_temperatureDue, _temperatureMaxDelay, _humidityDue)){
+		temperatureDue = false;
+	}
+	if(!humidityDue && !temperatureDue){
+		return;
+	}
+
+	//the application is using the sensor, or a dropped conversion is still running: poll() moves it along
+	if(_sensor->poll() == Si7021::STATE_CONVERTING){
+		return;
+	}
+
+	//a sensor reported missing fails every call without bus traffic: ask it again first, a single address byte
+	bool started = _sensor->isPresent() || _sensor->probe() == Si7021::STATUS_OK;
+	if(started && humidityDue){
+		_sensor->setSensorResolution(_humidityResolution);
+		started = _sensor->startHumidityMeasurement(true);
+		_pending = SI7021_SCHEDULER_HUMIDITY | SI7021_SCHEDULER_TEMPERATURE;
+	}
+	else if(started){
+		_sensor->setSensorResolution(_temperatureResolution);
+		started = _sensor->startTemperatureMeasurement();
+		_pending = SI7021_SCHEDULER_TEMPERATURE;
+	}
+	_startTime = now;
+
+	//keep a fixed rate, unless more than a full interval late. A missing sensor is tried again at the same rate
+	if(humidityDue){
+		_humidityDue += _humidityInterval;
+		if((int32_t)(now - _humidityDue) >= 0){
+			_humidityDue = now + _humidityInterval;
+		}
+	}
+	if(_temperatureInterval){
+		if(temperatureDue){
+			_temperatureDue += _temperatureInterval;
+		}
+		//a temperature coming early with the humidity moves the next one back
+		if(!temperatureDue || (int32_t)(now - _temperatureDue) >= 0){
+			_temperatureDue = now + _temperatureInterval;
+		}
+	}
+
+	if(!started){
+		_pending = 0;
+	}
+}
+
+/// <returns>Raw code of the latest temperature, see Si7021::convertTemperature()</returns>
+uint16_t Si7021Scheduler::getTemperatureCode(){
+	return _temperatureCode;
+}
+
+/// <returns>Raw code of the latest humidity, see Si7021::convertHumidity()</returns>
+uint16_t Si7021Scheduler::getHumidityCode(){
+	return _humidityCode;
+}
+
+/// <returns>Time since the latest temperature conversion started, in milliseconds. 0xFFFFFFFF if none yet</returns>
+uint32_t Si7021Scheduler::getTemperatureAge(){
+	return (_sampled & SI7021_SCHEDULER_TEMPERATURE) ? _sensor->getMillis() - _temperatureTime : 0xFFFFFFFF;
+}
+
+/// <returns>Time since the latest humidity conversion started, in milliseconds. 0xFFFFFFFF if none yet</returns>
+uint32_t Si7021Scheduler::getHumidityAge(){
+	return (_sampled & SI7021_SCHEDULER_HUMIDITY) ? _sensor->getMillis() - _humidityTime : 0xFFFFFFFF;
+}
+
+/// <summary>
+///		Check if values are missing or a sample was missed, eg: because the sensor stopped answering.
+///		A value is stale once older than two intervals plus the delay allowed.
+/// </summary>
+/// <param name="quantity">SI7021_SCHEDULER_TEMPERATURE and/or SI7021_SCHEDULER_HUMIDITY, only the ones with a plan are checked</param>
+/// <returns>TRUE if any of them is stale</returns>
+bool Si7021Scheduler::isStale(uint8_t quantity){
+	if((quantity & SI7021_SCHEDULER_TEMPERATURE) && _temperatureInterval &&
+			this->getTemperatureAge() > 2 * _temperatureInterval + _temperatureMaxDelay){
+		return true;
+	}
+	return (quantity & SI7021_SCHEDULER_HUMIDITY) && _humidityInterval &&
+		this->getHumidityAge() > 2 * _humidityInterval + _humidityMaxDelay;
+}
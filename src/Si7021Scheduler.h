@@ -0,0 +1,57 @@
+/*
+  Si7021Scheduler.h
+  Sample temperature and humidity at different rates, with the fewest conversions:
+  a humidity conversion brings the temperature along with it, temperature only
+  conversions run at their own, usually lower, resolution.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_SCHEDULER_H
+#define SI7021_SCHEDULER_H
+
+#include <stdint.h>
+#include "Si7021.h"
+
+//quantities updated by Si7021Scheduler::poll(), as a mask
+#define SI7021_SCHEDULER_TEMPERATURE 0x01
+#define SI7021_SCHEDULER_HUMIDITY 0x02
+
+
+class Si7021Scheduler
+{
+	private:
+		Si7021* _sensor;
+		uint32_t _temperatureInterval;
+		uint32_t _temperatureMaxDelay;
+		uint8_t _temperatureResolution;
+		uint32_t _humidityInterval;
+		uint32_t _humidityMaxDelay;
+		uint8_t _humidityResolution;
+		uint32_t _temperatureDue;
+		uint32_t _humidityDue;
+		uint32_t _temperatureTime;
+		uint32_t _humidityTime;
+		uint16_t _temperatureCode;
+		uint16_t _humidityCode;
+		uint8_t _sampled;
+		uint8_t _pending;
+		uint32_t _startTime;
+		bool canWait(uint32_t due, uint32_t maxDelay, uint32_t until);
+		uint8_t collect(bool ready);
+		void schedule();
+	public:
+		Si7021Scheduler(Si7021& sensor);
+		void setTemperaturePlan(uint32_t interval, uint32_t maxDelay = 0, uint8_t resolution = 1);
+		void setHumidityPlan(uint32_t interval, uint32_t maxDelay = 0, uint8_t resolution = 0);
+		uint8_t poll();
+		uint16_t getTemperatureCode();
+		uint16_t getHumidityCode();
+		uint32_t getTemperatureAge();
+		uint32_t getHumidityAge();
+		bool isStale(uint8_t quantity);
+};
+
+#endif
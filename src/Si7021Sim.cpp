@@ -0,0 +1,244 @@
+/*
+  Si7021Sim.cpp
+  Model of a Si7021 on its own bus, with a virtual clock. Lets the driver run
+  on a board without a sensor, and be measured: conversion times per
+  resolution, NACK until the conversion is done, clock stretching in hold
+  master mode and injected checksum errors.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021.h"
+#include "Si7021Sim.h"
+
+//typical conversion times from the datasheet, in microseconds, indexed by RES[1:0]. A real part is usually done before
+//the worst case times used by the driver, which is what READY_NACK_POLLING takes advantage of
+static const uint16_t SI7021_SIM_HUMIDITY_TIME[4] PROGMEM = { 10000, 2600, 3700, 5800 };
+static const uint16_t SI7021_SIM_TEMPERATURE_TIME[4] PROGMEM = { 7000, 2400, 4000, 1500 };
+
+//electronic ID of the model: SNB_3 = 0x15, a Si7021
+static const uint8_t SI7021_SIM_SERIAL[8] PROGMEM = { 0x5E, 0x51, 0x70, 0x21, 0x15, 0xFF, 0xB5, 0xFF };
+
+Si7021Sim::Si7021Sim(uint8_t address) : _address(address), _now(0), _millis(0), _fraction(0), _byteTime(9000000UL / SI7021_SIM_BUS_CLOCK), _busyUntil(0), _userRegister(SI7021_USER_REGISTER_DEFAULT), _heaterRegister(SI7021_HEATER_CONTROL_REGISTER_DEFAULT), _command(0x00), _hold(false), _humidityCode(0), _temperatureCode(0), _outputSize(0), _crcErrorInterval(0), _frames(0), _transactions(0), _nacks(0) {
+	this->setEnvironment(5000, 2500);
+};
+
+/// <summary>Speed of the modelled bus, for the time taken by the transactions</summary>
+/// <param name="hz">I2C clock, in Hertz</param>
+void Si7021Sim::setBusClock(uint32_t hz){
+	_byteTime = 9000000UL / hz;
+}
+
+/// <summary>Conditions the model measures</summary>
+/// <param name="humidityCenti">Relative Humidity, in hundredths of a percent</param>
+/// <param name="temperatureCenti">Temperature, in hundredths of a degree Celcius</param>
+void Si7021Sim::setEnvironment(uint16_t humidityCenti, int16_t temperatureCenti){
+	//inverse of the conversion formulas of the datasheet
+	_humidityCode = (uint16_t)((((uint32_t)humidityCenti + 600) << 16) / 12500) & 0xFFFC;
+	_temperatureCode = (uint16_t)((((int32_t)temperatureCenti + 4685) << 16) / 17572) & 0xFFFC;
+}
+
+/// <summary>Corrupt the checksum of every interval-th measurement frame</summary>
+/// <param name="interval">0 to never corrupt a frame</param>
+void Si7021Sim::setCrcErrorInterval(uint16_t interval){
+	_crcErrorInterval = interval;
+	_frames = 0;
+}
+
+/// <returns>Number of transactions on the bus, NACKed ones included</returns>
+uint32_t Si7021Sim::getTransactions(){
+	return _transactions;
+}
+
+/// <returns>Number of transactions the model NACKed, eg: read attempts before the end of a conversion</returns>
+uint32_t Si7021Sim::getNacks(){
+	return _nacks;
+}
+
+/// <summary>Clear the transaction and NACK counters</summary>
+void Si7021Sim::resetCounters(){
+	_transactions = 0;
+	_nacks = 0;
+}
+
+void Si7021Sim::begin(){
+}
+
+/// <summary>Conversion time of the model at the current resolution</summary>
+/// <param name="humidity">TRUE for a humidity measurement, which converts the temperature as well</param>
+/// <returns>Conversion time, in microseconds</returns>
+uint32_t Si7021Sim::getConversionTime(bool humidity){
+	uint8_t resolution = ((_userRegister >> 6) & 0x02) | (_userRegister & 0x01);
+	uint32_t time = pgm_read_word(&SI7021_SIM_TEMPERATURE_TIME[resolution]);
+	if(humidity){
+		time += pgm_read_word(&SI7021_SIM_HUMIDITY_TIME[resolution]);
+	}
+	return time;
+}
+
+/// <summary>Advance the virtual clock. Milliseconds are counted apart so they wrap at 2^32 like millis() does</summary>
+/// <param name="us">Time elapsed, in microseconds</param>
+void Si7021Sim::advance(uint32_t us){
+	_now += us;
+	uint32_t fraction = _fraction + us;
+	_millis += fraction / 1000;
+	_fraction = fraction % 1000;
+}
+
+/// <summary>Prepare the answer to a measurement</summary>
+/// <param name="code">Code to send</param>
+/// <param name="crc">TRUE to follow with the checksum, possibly corrupted</param>
+void Si7021Sim::setFrame(uint16_t code, bool crc){
+	_output[0] = code >> 8;
+	_output[1] = code & 0xFF;
+	_outputSize = 2;
+	if(crc){
+		//a humidity code has its status bit set
+		if(_command == SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE || _command == SI7021_MEASURE_HUMIDIY_HOLD_MASTER_MODE){
+			_output[1] |= 0x02;
+		}
+		_output[2] = Si7021::crc8(_output, 2);
+		if(_crcErrorInterval && ++_frames >= _crcErrorInterval){
+			_frames = 0;
+			_output[2] ^= 0x01;
+		}
+		_outputSize = 3;
+	}
+}
+
+uint8_t Si7021Sim::write(uint8_t address, const uint8_t* bytes, uint8_t length, bool stop){
+
+	//the address byte. No answer at all while converting, or while booting after a reset: the master stops there
+	_transactions++;
+	this->advance(_byteTime);
+	if(address != _address || (int32_t)(_now - _busyUntil) < 0){
+		_nacks++;
+		return 2;
+	}
+	this->advance(length * _byteTime);
+	if(length == 0){
+		return 0;
+	}
+
+	_command = bytes[0];
+	_hold = false;
+	_outputSize = 0;
+	switch(_command){
+		case SI7021_MEASURE_HUMIDIY_HOLD_MASTER_MODE:
+		case SI7021_MEASURE_TEMPERATURE_HOLD_MASTER_MODE:
+			_hold = true;
+			//fall through
+		case SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE:
+		case SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE:
+		{
+			bool humidity = _command == SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE || _command == SI7021_MEASURE_HUMIDIY_HOLD_MASTER_MODE;
+			_busyUntil = _now + this->getConversionTime(humidity);
+			this->setFrame(humidity ? _humidityCode : _temperatureCode, true);
+			break;
+		}
+		case SI7021_READ_TEMPERATURE_FROM_PREVIOUS_RH_MEASUREMENT:
+			this->setFrame(_temperatureCode, false);
+			break;
+		case SI7021_READ_USER_REGISTER:
+			_output[0] = _userRegister;
+			_outputSize = 1;
+			break;
+		case SI7021_READ_HEATER_CONTROL_REGISTER:
+			_output[0] = _heaterRegister;
+			_outputSize = 1;
+			break;
+		case SI7021_WRITE_USER_REGISTER:
+			if(length > 1){
+				_userRegister = bytes[1];
+			}
+			break;
+		case SI7021_WRITE_HEATER_CONTROL_REGISTER:
+			if(length > 1){
+				_heaterRegister = bytes[1];
+			}
+			break;
+		case SI7021_RESET:
+			_userRegister = SI7021_USER_REGISTER_DEFAULT;
+			_heaterRegister = SI7021_HEATER_CONTROL_REGISTER_DEFAULT;
+			_busyUntil = _now + 5000;
+			break;
+		case 0xFA:
+		case 0xFC:
+		{
+			//each checksum covers the serial number bytes of the access so far
+			bool first = _command == 0xFA;
+			uint8_t crc = 0x00;
+			uint8_t out = 0;
+			for(uint8_t i = 0; i < 4; i++){
+				uint8_t value = pgm_read_byte(&SI7021_SIM_SERIAL[(first ? 0 : 4) + i]);
+				crc = Si7021::crc8(&value, 1, crc);
+				_output[out++] = value;
+				if(first || (i & 1)){
+					_output[out++] = crc;
+				}
+			}
+			_outputSize = out;
+			break;
+		}
+		case 0x84:
+			_output[0] = 0x20;
+			_outputSize = 1;
+			break;
+		default:
+			_nacks++;
+			return 3;
+	}
+
+	(void)stop;
+	return 0;
+}
+
+uint8_t Si7021Sim::read(uint8_t address, uint8_t* buffer, uint8_t quantity){
+
+	_transactions++;
+	this->advance(_byteTime);
+	if(address != _address){
+		_nacks++;
+		return 0;
+	}
+
+	//in hold master mode the model acknowledges its address and stretches the clock until its conversion is done
+	bool busy = (int32_t)(_now - _busyUntil) < 0;
+	if(busy && _hold){
+		this->advance(_busyUntil - _now);
+	}
+	else if(busy){
+		_nacks++;
+		return 0;
+	}
+	_hold = false;
+	this->advance(quantity * _byteTime);
+
+	uint8_t received = quantity < _outputSize ? quantity : _outputSize;
+	for(uint8_t i = 0; i < received; i++){
+		buffer[i] = _output[i];
+	}
+	return received;
+}
+
+/// <returns>Virtual clock, in microseconds</returns>
+uint32_t Si7021Sim::micros(){
+	this->advance(SI7021_SIM_TICK);
+	return _now;
+}
+
+/// <returns>Virtual clock, in milliseconds</returns>
+uint32_t Si7021Sim::millis(){
+	this->advance(SI7021_SIM_TICK);
+	return _millis;
+}
+
+/// <summary>Advance the virtual clock: waiting costs no real time</summary>
+/// <param name="us">Time to wait, in microseconds</param>
+void Si7021Sim::wait(uint32_t us){
+	this->advance(us);
+}
@@ -0,0 +1,67 @@
+/*
+  Si7021Sim.h
+  Model of a Si7021 on its own bus, with a virtual clock. Lets the driver run
+  on a board without a sensor, and be measured: conversion times per
+  resolution, NACK until the conversion is done, clock stretching in hold
+  master mode and injected checksum errors.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021_SIM_H
+#define SI7021_SIM_H
+
+#include <stdint.h>
+#include "Si7021.h"
+#include "Si7021Bus.h"
+
+//default I2C clock of the model, in Hertz. Each byte on the bus takes 9 clock cycles
+#define SI7021_SIM_BUS_CLOCK 100000UL
+
+//virtual time taken by a call to micros() or millis(), in microseconds: keeps polling loops moving
+#define SI7021_SIM_TICK 1
+
+
+class Si7021Sim : public Si7021Bus
+{
+	private:
+		uint8_t _address;
+		uint32_t _now;
+		uint32_t _millis;
+		uint16_t _fraction;
+		uint32_t _byteTime;
+		uint32_t _busyUntil;
+		uint8_t _userRegister;
+		uint8_t _heaterRegister;
+		uint8_t _command;
+		bool _hold;
+		uint16_t _humidityCode;
+		uint16_t _temperatureCode;
+		uint8_t _output[8];
+		uint8_t _outputSize;
+		uint16_t _crcErrorInterval;
+		uint16_t _frames;
+		uint32_t _transactions;
+		uint32_t _nacks;
+		uint32_t getConversionTime(bool humidity);
+		void advance(uint32_t us);
+		void setFrame(uint16_t code, bool crc);
+	public:
+		Si7021Sim(uint8_t address = SI7021_ADDRESS);
+		void setBusClock(uint32_t hz);
+		void setEnvironment(uint16_t humidityCenti, int16_t temperatureCenti);
+		void setCrcErrorInterval(uint16_t interval);
+		uint32_t getTransactions();
+		uint32_t getNacks();
+		void resetCounters();
+		virtual void begin();
+		virtual uint8_t write(uint8_t address, const uint8_t* bytes, uint8_t length, bool stop);
+		virtual uint8_t read(uint8_t address, uint8_t* buffer, uint8_t quantity);
+		virtual uint32_t micros();
+		virtual uint32_t millis();
+		virtual void wait(uint32_t us);
+};
+
+#endif
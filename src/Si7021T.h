@@ -0,0 +1,210 @@
+/*
+  Si7021T.h
+  Compile-time configured variant of the Si7021 class, for small parts.
+  Resolution, checksum verification, output units and bus type are template
+  parameters: wait times are constants and unused code paths are never compiled.
+  Only the measurement path is provided: no heater, serial number or firmware version.
+
+  This example code is licensed under CC BY 4.0.
+  Please see https://creativecommons.org/licenses/by/4.0/
+
+*/
+
+#ifndef SI7021T_H
+#define SI7021T_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Si7021.h"
+
+//output units of Si7021T
+//SI7021_UNIT_RAW: codes of the sensor as is (uint16_t)
+//SI7021_UNIT_CENTI: hundredths of a degree Celcius (int16_t) and of a percent (uint16_t), integer math only
+//SI7021_UNIT_FLOAT: degrees Celcius and percent (float)
+#define SI7021_UNIT_RAW 0
+#define SI7021_UNIT_CENTI 1
+#define SI7021_UNIT_FLOAT 2
+
+
+template <uint8_t Unit> struct Si7021Unit;
+
+template <> struct Si7021Unit<SI7021_UNIT_RAW>
+{
+	typedef uint16_t Humidity;
+	typedef uint16_t Temperature;
+	static Humidity humidity(uint16_t code) { return code; }
+	static Temperature temperature(uint16_t code) { return code; }
+};
+
+template <> struct Si7021Unit<SI7021_UNIT_CENTI>
+{
+	typedef uint16_t Humidity;
+	typedef int16_t Temperature;
+	static Humidity humidity(uint16_t code) { return Si7021::convertHumidityCenti(code); }
+	static Temperature temperature(uint16_t code) { return Si7021::convertTemperatureCenti(code); }
+};
+
+template <> struct Si7021Unit<SI7021_UNIT_FLOAT>
+{
+	typedef float Humidity;
+	typedef float Temperature;
+	static Humidity humidity(uint16_t code) { return Si7021::convertHumidity(code); }
+	static Temperature temperature(uint16_t code) { return Si7021::convertTemperature(code); }
+};
+
+
+/// <summary>
+///		Si7021 driver configured at compile time.
+/// </summary>
+/// <typeparam name="Resolution">0 (12 bit RH, 14 bit Temperature), 1 (8 bit RH, 12 Bit Temperature), 2 (10 bit RH, 13 bit Temperature) or 3 (11 bit RH, 11 bit Temperature)</typeparam>
+/// <typeparam name="Crc">TRUE to verify the checksum of the measurements, as set by SI7021_CRC_MODE</typeparam>
+/// <typeparam name="Unit">SI7021_UNIT_RAW, SI7021_UNIT_CENTI or SI7021_UNIT_FLOAT</typeparam>
+/// <typeparam name="Bus">Any class with the TwoWire interface (beginTransmission, write, endTransmission, requestFrom, read)</typeparam>
+template <uint8_t Resolution = 0, bool Crc = true, uint8_t Unit = SI7021_UNIT_CENTI, class Bus = TwoWire>
+class Si7021T
+{
+	static_assert(Resolution < 4, "Resolution must be 0, 1, 2 or 3");
+
+	public:
+		typedef typename Si7021Unit<Unit>::Humidity Humidity;
+		typedef typename Si7021Unit<Unit>::Temperature Temperature;
+
+		//worst case conversion times at this resolution, in microseconds. A humidity measurement also converts the temperature
+		static const uint16_t TEMPERATURE_CONVERSION_TIME =
+			Resolution == 0 ? SI7021_TEMPERATURE_CONVERSION_TIME_14BIT :
+			Resolution == 1 ? SI7021_TEMPERATURE_CONVERSION_TIME_12BIT :
+			Resolution == 2 ? SI7021_TEMPERATURE_CONVERSION_TIME_13BIT :
+			SI7021_TEMPERATURE_CONVERSION_TIME_11BIT;
+		static const uint16_t HUMIDITY_CONVERSION_TIME = TEMPERATURE_CONVERSION_TIME + (
+			Resolution == 0 ? SI7021_HUMIDITY_CONVERSION_TIME_12BIT :
+			Resolution == 1 ? SI7021_HUMIDITY_CONVERSION_TIME_8BIT :
+			Resolution == 2 ? SI7021_HUMIDITY_CONVERSION_TIME_10BIT :
+			SI7021_HUMIDITY_CONVERSION_TIME_11BIT);
+
+	private:
+		//RES1 is D7, RES0 is D0. Other bits are left at their default: heater off
+		static const uint8_t USER_REGISTER = (SI7021_USER_REGISTER_DEFAULT & 0x7E) | ((Resolution & 0x02) << 6) | (Resolution & 0x01);
+
+		Bus& _bus;
+		uint8_t _address;
+
+		bool command(uint8_t instr) {
+			_bus.beginTransmission(_address);
+			_bus.write(instr);
+			return _bus.endTransmission() == 0;
+		}
+
+		bool readCode(uint8_t returnSize, uint16_t& code) {
+			uint8_t data[3];
+			if (_bus.requestFrom(_address, returnSize) < returnSize) {
+				return false;
+			}
+			for (uint8_t i = 0; i < returnSize; i++) {
+				data[i] = _bus.read();
+			}
+			if (Crc && returnSize >= 3 && Si7021::crc8(data, 2) != data[2]) {
+				return false;
+			}
+			//clear the status bits in the LSB
+			code = (uint16_t)((data[0] << 8) | (data[1] & 0xFC));
+			return true;
+		}
+
+		static void wait(uint16_t us) {
+			delay(us / 1000);
+			delayMicroseconds(us % 1000);
+		}
+
+	public:
+		Si7021T(Bus& bus, uint8_t address = SI7021_ADDRESS) : _bus(bus), _address(address) {};
+
+		/// <summary>
+		///		Initialize the bus and write the resolution to the sensor.
+		/// </summary>
+		/// <returns>FALSE if the sensor did not answer</returns>
+		bool begin() {
+			_bus.begin();
+			_bus.beginTransmission(_address);
+			_bus.write(SI7021_WRITE_USER_REGISTER);
+			_bus.write(USER_REGISTER);
+			return _bus.endTransmission() == 0;
+		}
+
+		/// <summary>
+		///		Start a relative humidity measurement without blocking. The result can be read with readHumidity()
+		///		HUMIDITY_CONVERSION_TIME microseconds later.
+		/// </summary>
+		/// <returns>FALSE if the sensor did not answer</returns>
+		bool startHumidityMeasurement() {
+			return this->command(SI7021_MEASURE_HUMIDIY_NO_HOLD_MASTER_MODE);
+		}
+
+		/// <summary>
+		///		Start a temperature measurement without blocking. The result can be read with readTemperature()
+		///		TEMPERATURE_CONVERSION_TIME microseconds later.
+		/// </summary>
+		/// <returns>FALSE if the sensor did not answer</returns>
+		bool startTemperatureMeasurement() {
+			return this->command(SI7021_MEASURE_TEMPERATURE_NO_HOLD_MASTER_MODE);
+		}
+
+		/// <summary>Read the result of startHumidityMeasurement()</summary>
+		/// <param name="humidity">Relative Humidity, in the unit of the template</param>
+		/// <returns>FALSE if the conversion is not done yet or the data was corrupted</returns>
+		bool readHumidity(Humidity& humidity) {
+			uint16_t code;
+			if (!this->readCode(3, code)) {
+				return false;
+			}
+			humidity = Si7021Unit<Unit>::humidity(code);
+			return true;
+		}
+
+		/// <summary>Read the result of startTemperatureMeasurement()</summary>
+		/// <param name="temperature">Temperature, in the unit of the template</param>
+		/// <returns>FALSE if the conversion is not done yet or the data was corrupted</returns>
+		bool readTemperature(Temperature& temperature) {
+			uint16_t code;
+			if (!this->readCode(3, code)) {
+				return false;
+			}
+			temperature = Si7021Unit<Unit>::temperature(code);
+			return true;
+		}
+
+		/// <summary>Measure the humidity. Blocks for HUMIDITY_CONVERSION_TIME</summary>
+		/// <param name="humidity">Relative Humidity, in the unit of the template</param>
+		/// <returns>FALSE if the sensor did not answer or the data was corrupted</returns>
+		bool measureHumidity(Humidity& humidity) {
+			if (!this->startHumidityMeasurement()) {
+				return false;
+			}
+			wait(HUMIDITY_CONVERSION_TIME);
+			return this->readHumidity(humidity);
+		}
+
+		/// <summary>Measure the temperature. Blocks for TEMPERATURE_CONVERSION_TIME</summary>
+		/// <param name="temperature">Temperature, in the unit of the template</param>
+		/// <returns>FALSE if the sensor did not answer or the data was corrupted</returns>
+		bool measureTemperature(Temperature& temperature) {
+			if (!this->startTemperatureMeasurement()) {
+				return false;
+			}
+			wait(TEMPERATURE_CONVERSION_TIME);
+			return this->readTemperature(temperature);
+		}
+
+		/// <summary>Read back the temperature converted along with the previous humidity measurement. No conversion wait</summary>
+		/// <param name="temperature">Temperature, in the unit of the template</param>
+		/// <returns>FALSE if the sensor did not answer</returns>
+		bool getTemperatureFromPreviousHumidityMeasurement(Temperature& temperature) {
+			uint16_t code;
+			if (!this->command(SI7021_READ_TEMPERATURE_FROM_PREVIOUS_RH_MEASUREMENT) || !this->readCode(2, code)) {
+				return false;
+			}
+			temperature = Si7021Unit<Unit>::temperature(code);
+			return true;
+		}
+};
+
+#endif